@@ -0,0 +1,566 @@
+/****************************************************************************
+* Name:    bench.c
+*
+* Creator: Frank Wallis
+* Purpose: Benchmarks move generation, the chesspad search and knightspad,
+*          and writes the results to stdout as JSON so that builds can be
+*          compared with each other.
+*
+* History: 18/10/2026	FW	Created.
+*          18/10/2026	FW	Time the chesspad search in-process, apart from its output.
+*          18/10/2026	FW	Time chesspad's own search code, and the whole program.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "stdtypes.h"
+#include "keypad.h"
+#include "chess_moves.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "move_graph.h"
+#include "phone_search.h"
+
+#define BENCH_REPS_DEF 5
+#define BENCH_REPS_MAX 20
+#define BENCH_MAX_LENGTH_DEF 10
+#define BENCH_MAX_NUMBERS_DEF 20000000
+#define BENCH_LOOKUPS 10000000
+#define BENCH_WARMUP 1
+
+/* prototypes */
+
+void bench_available_squares(void);
+void bench_move_graph(void);
+void bench_chesspad(void);
+void bench_chesspad_program(void);
+void bench_knightspad(void);
+double time_search(int length, int null_fd);
+int run_program(char *argv[], double *seconds, int *lines);
+double time_program(char *argv[], int *lines);
+double now(void);
+double median(double *samples, int count);
+int compare_doubles(const void *a, const void *b);
+void display_usage(char *program_name);
+int process_args(int argc, char *argv[]);
+
+/* globals */
+
+static char *g_pieces[] = {"king", "queen", "bishop", "knight", "rook", "pawn", "underpawn"};
+static char *g_piece_enums[] = {"king", "queen", "bishop", "knight", "rook", "pawn", "pawn_special"};
+
+#define NUM_BENCH_PIECES (sizeof(g_pieces) / sizeof(g_pieces[0]))
+
+int g_repetitions = BENCH_REPS_DEF;
+int g_max_length = BENCH_MAX_LENGTH_DEF;
+double g_max_numbers = BENCH_MAX_NUMBERS_DEF;
+
+int main(int argc, char *argv[])
+{
+	if (!process_args(argc, argv))
+	{
+		display_usage(argv[0]);
+		return 1;
+	}
+
+	printf("{\n");
+	printf("  \"timestamp\": %ld,\n", (long)time(NULL));
+	printf("  \"repetitions\": %d,\n", g_repetitions);
+	printf("  \"warmup\": %d,\n", BENCH_WARMUP);
+
+	bench_available_squares();
+	bench_move_graph();
+	bench_chesspad();
+	bench_chesspad_program();
+	bench_knightspad();
+
+	printf("}\n");
+	return 0;
+}
+
+/*
+	void bench_available_squares(void)
+	times get_available_squares for each piece, both the first call for
+	each square which fills the lookup table, and later cached calls
+*/
+void bench_available_squares(void)
+{
+	coor squares[KEYPAD_WIDTH * KEYPAD_HEIGHT];
+	double fill[BENCH_REPS_MAX], cached[BENCH_REPS_MAX];
+	double start;
+	volatile int sink = 0;
+	int piece, rep, i;
+
+	for (i = 0; i < KEYPAD_WIDTH * KEYPAD_HEIGHT; i++)
+	{
+		squares[i].x = i / KEYPAD_HEIGHT;
+		squares[i].y = i % KEYPAD_HEIGHT;
+	}
+
+	fprintf(stderr, "Timing get_available_squares\n");
+	printf("  \"get_available_squares\": [\n");
+
+	for (piece = 0; piece < NUM_PIECES; piece++)
+	{
+		for (rep = -BENCH_WARMUP; rep < g_repetitions; rep++)
+		{
+			/* the first lookup on each square fills the table */
+			initialise_board(KEYPAD_WIDTH, KEYPAD_HEIGHT);
+			start = now();
+			for (i = 0; i < KEYPAD_WIDTH * KEYPAD_HEIGHT; i++)
+				sink += get_available_squares(squares + i, piece)->count;
+
+			if (rep >= 0)
+				fill[rep] = (now() - start) * 1e9 / (KEYPAD_WIDTH * KEYPAD_HEIGHT);
+
+			/* and the rest just read it */
+			start = now();
+			for (i = 0; i < BENCH_LOOKUPS; i++)
+				sink += get_available_squares(squares + (i % (KEYPAD_WIDTH * KEYPAD_HEIGHT)), piece)->count;
+
+			if (rep >= 0)
+				cached[rep] = (now() - start) * 1e9 / BENCH_LOOKUPS;
+		}
+
+		printf("    {\"piece\": \"%s\", \"first_fill_ns\": %.1f, \"cached_ns\": %.2f}%s\n",
+			   g_piece_enums[piece], median(fill, g_repetitions), median(cached, g_repetitions),
+			   (piece < NUM_PIECES - 1) ? "," : "");
+	}
+
+	printf("  ],\n");
+	free_board();
+	return;
+}
+
+/*
+	void bench_move_graph(void)
+	times compiling each piece into a move graph, and counting the
+	phone numbers of the maximum length over it
+*/
+void bench_move_graph(void)
+{
+	static piece_def def;
+	move_graph graph;
+	uint64_t *counts;
+	double build[BENCH_REPS_MAX], count[BENCH_REPS_MAX];
+	double start;
+	int piece, rep;
+	char name[PIECE_NAME_MAX];
+
+	fprintf(stderr, "Timing move graphs\n");
+	printf("  \"move_graph\": [\n");
+
+	for (piece = 0; piece < NUM_BENCH_PIECES; piece++)
+	{
+		strcpy(name, g_pieces[piece]);
+		get_piece_def(name, &def);
+
+		for (rep = -BENCH_WARMUP; rep < g_repetitions; rep++)
+		{
+			start = now();
+			build_move_graph(&def, &graph);
+			if (rep >= 0)
+				build[rep] = (now() - start) * 1e9;
+
+			start = now();
+			counts = build_count_table(&graph, PHONENO_LENGTH_MAX);
+			if (rep >= 0)
+				count[rep] = (now() - start) * 1e9;
+
+			free(counts);
+			if (rep < g_repetitions - 1)
+				free_move_graph(&graph);
+		}
+
+		printf("    {\"piece\": \"%s\", \"nodes\": %d, \"successors\": %d, \"build_ns\": %.0f, \"count_ns\": %.0f}%s\n",
+			   g_pieces[piece], graph.node_count, graph.succ_total, median(build, g_repetitions),
+			   median(count, g_repetitions), (piece < NUM_BENCH_PIECES - 1) ? "," : "");
+		free_move_graph(&graph);
+	}
+
+	printf("  ],\n");
+	return;
+}
+
+/*
+	void bench_chesspad(void)
+	times chesspad's search (phone_search.c) over a move graph built
+	once for each piece, for every length and starting from every key.
+	Each search is run once without output and once writing the numbers
+	to /dev/null, as chesspad --stats does, so that the search and the
+	output can be told apart. The numbers and the nodes visited come from the count
+	table, as the search visits one node for each distinct prefix of
+	each length.
+*/
+void bench_chesspad(void)
+{
+	static piece_def def;
+	coor square;
+	double numbers, nodes, bytes, search[BENCH_REPS_MAX], total[BENCH_REPS_MAX];
+	double search_seconds, output_seconds;
+	char name[PIECE_NAME_MAX];
+	int piece, length, depth, root, rep, null_fd, first = TRUE;
+
+	null_fd = open("/dev/null", O_WRONLY);
+	if (null_fd < 0)
+	{
+		fprintf(stderr, "Cannot open /dev/null\n");
+		exit(1);
+	}
+
+	fprintf(stderr, "Timing chesspad\n");
+	printf("  \"chesspad\": [\n");
+
+	for (piece = 0; piece < NUM_BENCH_PIECES; piece++)
+	{
+		strcpy(name, g_pieces[piece]);
+		get_piece_def(name, &def);
+		build_move_graph(&def, &g_graph);
+		g_counts = build_count_table(&g_graph, PHONENO_LENGTH_MAX);
+
+		for (length = 1; length <= g_max_length; length++)
+		{
+			numbers = nodes = 0;
+
+			/* total up the work for every starting key */
+			for (square.x = 0; square.x < KEYPAD_WIDTH; square.x++)
+			{
+				for (square.y = 0; square.y < KEYPAD_HEIGHT; square.y++)
+				{
+					root = graph_root(&g_graph, &square);
+					if (root == -1)
+						continue;
+
+					numbers += graph_count(&g_graph, g_counts, root, length);
+					for (depth = 1; depth <= length; depth++)
+						nodes += graph_count(&g_graph, g_counts, root, depth);
+				}
+			}
+
+			printf("%s    {\"piece\": \"%s\", \"length\": %d, \"numbers\": %.0f, \"nodes\": %.0f",
+				   first ? "" : ",\n", g_pieces[piece], length, numbers, nodes);
+			first = FALSE;
+
+			if (numbers > g_max_numbers)
+			{
+				printf(", \"skipped\": true}");
+				continue;
+			}
+
+			fprintf(stderr, "  %s length %d\n", g_pieces[piece], length);
+
+			for (rep = -BENCH_WARMUP; rep < g_repetitions; rep++)
+			{
+				search[(rep < 0) ? 0 : rep] = time_search(length, -1);
+				total[(rep < 0) ? 0 : rep] = time_search(length, null_fd);
+			}
+
+			if (g_output_counter != numbers)
+			{
+				fprintf(stderr, "The search found %llu numbers, not %.0f\n",
+						(unsigned long long)g_output_counter, numbers);
+				exit(1);
+			}
+
+			search_seconds = median(search, g_repetitions);
+			output_seconds = median(total, g_repetitions) - search_seconds;
+			bytes = numbers * (length + 1);
+
+			printf(", \"search_seconds\": %.9f, \"numbers_per_sec\": %.0f, \"nodes_per_sec\": %.0f",
+				   search_seconds, numbers / search_seconds, nodes / search_seconds);
+
+			/* at short lengths the output can be lost in the noise */
+			if (output_seconds > 0)
+				printf(", \"output_seconds\": %.9f, \"output_bytes_per_sec\": %.0f}", output_seconds,
+					   bytes / output_seconds);
+			else
+				printf(", \"output_seconds\": 0}");
+		}
+
+		free(g_counts);
+		free_move_graph(&g_graph);
+	}
+
+	printf("\n  ],\n");
+	close(null_fd);
+	return;
+}
+
+/*
+	void bench_chesspad_program(void)
+	times the chesspad program as a whole, building its graph and
+	writing the numbers to a pipe, for a queen on 5 at the longest
+	length within the limits
+*/
+void bench_chesspad_program(void)
+{
+	static piece_def def;
+	coor square;
+	char name[PIECE_NAME_MAX] = "queen";
+	char length_arg[16];
+	char *args[] = {"./chesspad", name, "5", length_arg, NULL};
+	double numbers = 0, count, seconds;
+	int root, length, lines;
+
+	get_piece_def(name, &def);
+	build_move_graph(&def, &g_graph);
+	g_counts = build_count_table(&g_graph, PHONENO_LENGTH_MAX);
+	square = key_to_square('5');
+	root = graph_root(&g_graph, &square);
+
+	for (length = 1; length <= g_max_length; length++)
+	{
+		count = graph_count(&g_graph, g_counts, root, length);
+		if (count > g_max_numbers)
+			break;
+		numbers = count;
+	}
+	length--;
+
+	free(g_counts);
+	free_move_graph(&g_graph);
+
+	fprintf(stderr, "Timing the chesspad program\n");
+	sprintf(length_arg, "%d", length);
+	seconds = time_program(args, &lines);
+
+	if (lines != numbers)
+	{
+		fprintf(stderr, "chesspad wrote %d numbers, not %.0f\n", lines, numbers);
+		exit(1);
+	}
+
+	printf("  \"chesspad_program\": {\"piece\": \"%s\", \"key\": \"5\", \"length\": %d, \"numbers\": %.0f, "
+		   "\"seconds\": %.6f, \"numbers_per_sec\": %.0f},\n", name, length, numbers, seconds, numbers / seconds);
+	return;
+}
+
+/*
+	double time_search(int length, int null_fd)
+	returns the time chesspad's search takes to find the numbers of
+	length digits in g_graph from every key. It writes them to stdout,
+	pointed at null_fd for the search, unless null_fd is -1.
+*/
+double time_search(int length, int null_fd)
+{
+	coor square;
+	double start, seconds;
+	int root, saved_fd = -1;
+
+	g_phoneno_length = length;
+	g_output_summary = (null_fd < 0);
+	g_output_counter = 0;
+	memset(g_output, 0, sizeof(g_output));
+
+	if (!g_output_summary)
+	{
+		fflush(stdout);
+		saved_fd = dup(STDOUT_FILENO);
+		if ((saved_fd < 0) || (dup2(null_fd, STDOUT_FILENO) < 0))
+		{
+			fprintf(stderr, "Cannot redirect stdout\n");
+			exit(1);
+		}
+	}
+
+	start = now();
+
+	for (square.x = 0; square.x < KEYPAD_WIDTH; square.x++)
+	{
+		for (square.y = 0; square.y < KEYPAD_HEIGHT; square.y++)
+		{
+			root = graph_root(&g_graph, &square);
+			if (root != -1)
+				output_moves(root, 0);
+		}
+	}
+
+	if (!g_output_summary)
+		fflush(stdout);
+
+	seconds = now() - start;
+
+	if (saved_fd >= 0)
+	{
+		dup2(saved_fd, STDOUT_FILENO);
+		close(saved_fd);
+	}
+
+	return seconds;
+}
+
+/*
+	void bench_knightspad(void)
+	runs knightspad from every key, counting the tours it finds
+*/
+void bench_knightspad(void)
+{
+	coor square;
+	char key[2] = {0, 0};
+	char *args[] = {"./knightspad", key, NULL};
+	double seconds;
+	int lines, first = TRUE;
+
+	fprintf(stderr, "Timing knightspad\n");
+	printf("  \"knightspad\": [\n");
+
+	for (square.x = 0; square.x < KEYPAD_WIDTH; square.x++)
+	{
+		for (square.y = 0; square.y < KEYPAD_HEIGHT; square.y++)
+		{
+			key[0] = key_for_square(&square);
+			seconds = time_program(args, &lines);
+
+			/* the last line is the summary */
+			printf("%s    {\"key\": \"%c\", \"tours\": %d, \"seconds\": %.6f, \"tours_per_sec\": %.1f}",
+				   first ? "" : ",\n", key[0], lines - 1, seconds, (lines - 1) / seconds);
+			first = FALSE;
+		}
+	}
+
+	printf("\n  ]\n");
+	return;
+}
+
+/*
+	double time_program(char * argv[], int * lines)
+	runs the program after a warm-up, and returns the median time taken
+*/
+double time_program(char *argv[], int *lines)
+{
+	double samples[BENCH_REPS_MAX];
+	int rep;
+
+	for (rep = -BENCH_WARMUP; rep < g_repetitions; rep++)
+	{
+		if (!run_program(argv, samples + ((rep < 0) ? 0 : rep), lines))
+		{
+			fprintf(stderr, "Failed to run %s\n", argv[0]);
+			exit(1);
+		}
+	}
+
+	return median(samples, g_repetitions);
+}
+
+/*
+	int run_program(char * argv[], double * seconds, int * lines)
+	runs the program, counting the lines it writes.
+	returns FALSE if it fails.
+*/
+int run_program(char *argv[], double *seconds, int *lines)
+{
+	int fds[2], status, i, n;
+	char buffer[4096];
+	double start;
+	pid_t pid;
+
+	if (pipe(fds) != 0)
+		return FALSE;
+
+	start = now();
+	pid = fork();
+
+	if (pid == 0)
+	{
+		dup2(fds[1], STDOUT_FILENO);
+		execv(argv[0], argv);
+		_exit(127);
+	}
+
+	close(fds[1]);
+	*lines = 0;
+
+	while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+		for (i = 0; i < n; i++)
+			if (buffer[i] == '\n')
+				(*lines)++;
+
+	close(fds[0]);
+
+	if ((pid < 0) || (waitpid(pid, &status, 0) != pid))
+		return FALSE;
+
+	*seconds = now() - start;
+	return (WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+/*
+	double now(void)
+	returns a monotonic time in seconds, with nanosecond resolution
+*/
+double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/*
+	double median(double * samples, int count)
+	returns the median of the samples, which are sorted in place
+*/
+double median(double *samples, int count)
+{
+	qsort(samples, count, sizeof(double), compare_doubles);
+
+	if (count % 2)
+		return samples[count / 2];
+
+	return (samples[(count / 2) - 1] + samples[count / 2]) / 2;
+}
+
+int compare_doubles(const void *a, const void *b)
+{
+	double diff = *(const double *)a - *(const double *)b;
+	return (diff > 0) - (diff < 0);
+}
+
+/*
+	void display_usage(char * program_name)
+	show accepted command line args
+*/
+void display_usage(char *program_name)
+{
+	printf("Usage %s [ <max_length> <repetitions> <max_numbers> ]\n", program_name);
+}
+
+/*
+	int process_args(int argc, char* argv[])
+	get the benchmark settings from the input parameters
+	return true only if the inputs are valid
+*/
+int process_args(int argc, char *argv[])
+{
+	if (argc > 1)
+	{
+		g_max_length = atoi(argv[1]);
+		if ((g_max_length < 1) || (g_max_length > PHONENO_LENGTH_MAX))
+		{
+			printf("Phone numbers must be between 1 and %d digits long\n", PHONENO_LENGTH_MAX);
+			return FALSE;
+		}
+	}
+
+	if (argc > 2)
+	{
+		g_repetitions = atoi(argv[2]);
+		if ((g_repetitions < 1) || (g_repetitions > BENCH_REPS_MAX))
+		{
+			printf("Repetitions must be between 1 and %d\n", BENCH_REPS_MAX);
+			return FALSE;
+		}
+	}
+
+	if (argc > 3)
+		g_max_numbers = atof(argv[3]);
+
+	return TRUE;
+}
@@ -0,0 +1,195 @@
+/*****************************************************************
+* Name:    checkpoint.c
+*
+* Creator: Frank Wallis
+* Purpose: Saves and loads the position of a long search, so that
+*          it can be resumed if it is stopped. A timer sets
+*          g_checkpoint_due, and the search saves its position the
+*          next time it is between two numbers.
+*
+* History: 18/10/2026	FW	Created.
+*          18/10/2026	FW	Record whether the search is --sorted.
+*          18/10/2026	FW	Allow intervals of less than a second.
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "stdtypes.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_HEADER "chesspad checkpoint 1"
+
+/* prototypes */
+int start_checkpoint_timer(double interval);
+void restart_checkpoint_timer(void);
+void stop_checkpoint_timer(void);
+int write_checkpoint(char *file, checkpoint_rec *rec);
+int read_checkpoint(char *file, checkpoint_rec *rec);
+
+void checkpoint_alarm(int signal);
+
+/* globals */
+
+volatile sig_atomic_t g_checkpoint_due = FALSE;
+static struct itimerval g_checkpoint_timer;
+
+/*
+	int start_checkpoint_timer(double interval)
+	sets g_checkpoint_due every interval seconds, which may be a
+	fraction of a second, after the search calls
+	restart_checkpoint_timer. returns FALSE if it cannot.
+*/
+int start_checkpoint_timer(double interval)
+{
+	struct sigaction action;
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = checkpoint_alarm;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+
+	if (sigaction(SIGALRM, &action, NULL) != 0)
+		return FALSE;
+
+	/* one shot, as the search restarts it after each checkpoint */
+	memset(&g_checkpoint_timer, 0, sizeof(g_checkpoint_timer));
+	g_checkpoint_timer.it_value.tv_sec = (time_t)interval;
+	g_checkpoint_timer.it_value.tv_usec = (suseconds_t)((interval - (time_t)interval) * 1e6);
+	if ((g_checkpoint_timer.it_value.tv_sec == 0) && (g_checkpoint_timer.it_value.tv_usec == 0))
+		g_checkpoint_timer.it_value.tv_usec = 1;
+
+	restart_checkpoint_timer();
+	return TRUE;
+}
+
+/*
+	void restart_checkpoint_timer(void)
+	clears g_checkpoint_due and waits for the next interval
+*/
+void restart_checkpoint_timer(void)
+{
+	g_checkpoint_due = FALSE;
+	setitimer(ITIMER_REAL, &g_checkpoint_timer, NULL);
+	return;
+}
+
+/*
+	void stop_checkpoint_timer(void)
+	stops any more checkpoints falling due
+*/
+void stop_checkpoint_timer(void)
+{
+	struct itimerval stop;
+
+	memset(&stop, 0, sizeof(stop));
+	setitimer(ITIMER_REAL, &stop, NULL);
+	g_checkpoint_due = FALSE;
+	return;
+}
+
+/*
+	void checkpoint_alarm(int signal)
+	SIGALRM handler, which just flags that a checkpoint is due
+*/
+void checkpoint_alarm(int signal)
+{
+	g_checkpoint_due = TRUE;
+}
+
+/*
+	int write_checkpoint(char * file, checkpoint_rec * rec)
+	saves the position to file. It is written to a temporary file and
+	renamed, so that file always holds a complete checkpoint.
+	returns FALSE if it cannot be written.
+*/
+int write_checkpoint(char *file, checkpoint_rec *rec)
+{
+	char temp_file[FILENAME_MAX];
+	FILE *out;
+	int ok;
+
+	if (snprintf(temp_file, sizeof(temp_file), "%s.tmp", file) >= sizeof(temp_file))
+		return FALSE;
+
+	out = fopen(temp_file, "w");
+	if (out == NULL)
+		return FALSE;
+
+	fprintf(out, "%s\n", CHECKPOINT_HEADER);
+	fprintf(out, "piece %s\n", rec->piece);
+	fprintf(out, "key %c\n", rec->key);
+	fprintf(out, "length %d\n", rec->length);
+	fprintf(out, "rank %llu\n", (unsigned long long)rec->rank);
+	fprintf(out, "offset %llu\n", (unsigned long long)rec->offset);
+	fprintf(out, "prefix %s\n", rec->prefix);
+	fprintf(out, "complete %d\n", rec->complete);
+	fprintf(out, "sorted %d\n", rec->sorted);
+
+	ok = (fflush(out) == 0) && (fsync(fileno(out)) == 0);
+	ok = (fclose(out) == 0) && ok;
+
+	if (!ok || (rename(temp_file, file) != 0))
+	{
+		remove(temp_file);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+	int read_checkpoint(char * file, checkpoint_rec * rec)
+	loads a position saved by write_checkpoint.
+	returns FALSE if the file is missing or invalid.
+*/
+int read_checkpoint(char *file, checkpoint_rec *rec)
+{
+	char line[PIECE_DEF_MAX + 16];
+	unsigned long long rank = 0, offset = 0;
+	FILE *in;
+	int ok;
+
+	memset(rec, 0, sizeof(checkpoint_rec));
+
+	in = fopen(file, "r");
+	if (in == NULL)
+		return FALSE;
+
+	ok = (fgets(line, sizeof(line), in) != NULL) && (strcmp(line, CHECKPOINT_HEADER "\n") == 0);
+
+	/* the piece may be a definition containing spaces, so take the whole line */
+	ok = ok && (fgets(line, sizeof(line), in) != NULL) && (strncmp(line, "piece ", 6) == 0);
+	if (ok)
+	{
+		line[strcspn(line, "\n")] = '\0';
+		strcpy(rec->piece, line + 6);
+	}
+
+	ok = ok && (fscanf(in, "key %c\n", &rec->key) == 1);
+	ok = ok && (fscanf(in, "length %d\n", &rec->length) == 1);
+	ok = ok && (fscanf(in, "rank %llu\n", &rank) == 1);
+	ok = ok && (fscanf(in, "offset %llu\n", &offset) == 1);
+	ok = ok && (fgets(line, sizeof(line), in) != NULL) && (strncmp(line, "prefix ", 7) == 0);
+	if (ok)
+	{
+		line[strcspn(line, "\n")] = '\0';
+		ok = (strlen(line + 7) <= PHONENO_LENGTH_MAX);
+		if (ok)
+			strcpy(rec->prefix, line + 7);
+	}
+
+	ok = ok && (fscanf(in, "complete %d\n", &rec->complete) == 1);
+	ok = ok && (fscanf(in, "sorted %d", &rec->sorted) == 1);
+
+	rec->rank = rank;
+	rec->offset = offset;
+
+	fclose(in);
+	return ok && (rec->length >= 1) && (rec->length <= PHONENO_LENGTH_MAX);
+}
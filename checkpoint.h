@@ -0,0 +1,40 @@
+/*****************************************************************
+* Name:    checkpoint.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for checkpoint.c
+*
+* History: 18/10/2026	FW	Created.
+*          18/10/2026	FW	Added sorted.
+*          18/10/2026	FW	Timer intervals in fractions of a second.
+******************************************************************/
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <signal.h>
+
+#define CHECKPOINT_INTERVAL_DEF 60
+
+/* the position a search had reached: rank numbers have been written,
+   taking offset bytes, and the next one starts with prefix */
+typedef struct
+{
+	char piece[PIECE_DEF_MAX];
+	char key;
+	int length;
+	uint64_t rank;
+	uint64_t offset;
+	char prefix[PHONENO_LENGTH_MAX + 1];
+	int complete;
+	int sorted;
+} checkpoint_rec;
+
+extern volatile sig_atomic_t g_checkpoint_due;
+
+extern int start_checkpoint_timer(double interval);
+extern void restart_checkpoint_timer(void);
+extern void stop_checkpoint_timer(void);
+extern int write_checkpoint(char *file, checkpoint_rec *rec);
+extern int read_checkpoint(char *file, checkpoint_rec *rec);
+
+#endif
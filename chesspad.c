@@ -6,39 +6,62 @@
 *           piece moving around a telephone keypad could produce.
 *
 * History: 06/10/2009	FW	Created.
+*          18/10/2026	FW	Search the compiled move graph of a piece definition.
+*          18/10/2026	FW	Added --stats.
+*          18/10/2026	FW	Added --progress and --status-file.
+*          18/10/2026	FW	Added --output, --checkpoint and --resume.
+*          18/10/2026	FW	Added --store.
+*          18/10/2026	FW	Added relays.
+*          18/10/2026	FW	Added --sorted.
+*          18/10/2026	FW	Moved the search to phone_search.c.
 *****************************************************************************/
 #include <stdio.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "stdtypes.h"
 #include "keypad.h"
-#include "chess_moves.h"
+#include "piece_defs.h"
 #include "chesspad.h"
+#include "move_graph.h"
+#include "search_stats.h"
+#include "progress.h"
+#include "checkpoint.h"
+#include "result_store.h"
+#include "phone_search.h"
 
 /* prototypes */
 
-void output_moves(int piece, coor *current_square, int digit);
-void next_move(int current_piece, coor *current_square, int current_digit);
-int reevaluate_piece(int current_piece, coor *current_square, int current_digit);
-void write_phoneno(void);
+int open_output(int root);
+int store_numbers(int root);
+void search(int root, search_stats *stats);
 void write_summary(time_t start_time);
-int process_args(int argc, char *argv[], int *piece, coor *start_key);
+int process_args(int argc, char *argv[], piece_def *piece, coor *start_key);
 void display_usage(char *program_name);
 
 /* globals */
 
-int g_phoneno_length = PHONENO_LENGTH_DEF;
-char g_output[PHONENO_LENGTH_MAX + 1] = {};
-double g_output_counter = 0;
-int g_output_summary = 0;
+int g_search_stats = FALSE;
+int g_progress_interval = 0;
+char *g_status_file = NULL;
+char *g_output_file = NULL;
+char *g_store_file = NULL;
+double g_checkpoint_interval = CHECKPOINT_INTERVAL_DEF;
+int g_resume = FALSE;
 
 int main(int argc, char *argv[])
 {
-	int start_piece;
+	static piece_def start_piece;
 	coor start_square;
 	time_t start_time;
+	uint64_t build_ns;
+	search_stats stats;
+	int root;
 
 	/* get piece and start key */
 	if (!process_args(argc, argv, &start_piece, &start_square))
@@ -47,18 +70,80 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	/* initialise the chess_moves library */
-	initialise_board(KEYPAD_WIDTH, KEYPAD_HEIGHT);
-
-	/* iterate through all the possible phone numbers */
+	/* compile the piece's moves around the keypad */
 	start_time = time(NULL);
-	output_moves(start_piece, &start_square, 0);
+	build_ns = clock_ns();
+	if (!build_move_graph(&start_piece, &g_graph))
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	/* move in key order, so that the search finds the numbers in order */
+	if (g_sorted)
+		sort_successors(&g_graph);
+
+	build_ns = clock_ns() - build_ns;
+	root = graph_root(&g_graph, &start_square);
+
+	if (g_search_stats && !collect_search_stats(&g_graph, root, g_phoneno_length, &stats))
+	{
+		printf("Out of memory\n");
+		free_move_graph(&g_graph);
+		return 1;
+	}
+
+	stats.build_ns = build_ns;
+
+	/* count the phone numbers from each node, for the summary, progress and resuming */
+	stats.count_ns = clock_ns();
+	g_counts = build_count_table(&g_graph, g_phoneno_length);
+	if (g_counts == NULL)
+	{
+		printf("Out of memory\n");
+		free_move_graph(&g_graph);
+		return 1;
+	}
+	stats.count_ns = clock_ns() - stats.count_ns;
 
-	if (g_output_summary)
+	if (g_store_file != NULL)
+	{
+		if (!store_numbers(root))
+		{
+			free(g_counts);
+			free_move_graph(&g_graph);
+			return 1;
+		}
 		write_summary(start_time);
+	}
+	else if (g_output_summary)
+	{
+		g_output_counter = graph_count(&g_graph, g_counts, root, g_phoneno_length);
+		write_summary(start_time);
+	}
+	else
+	{
+		if (!open_output(root))
+		{
+			free(g_counts);
+			free_move_graph(&g_graph);
+			return 1;
+		}
 
-	/* release the chess_moves library */
-	free_board();
+		if (g_progress_interval > 0)
+			start_progress(&g_output_counter, graph_count(&g_graph, g_counts, root, g_phoneno_length),
+						   g_progress_interval, g_status_file);
+
+		/* iterate through all the possible phone numbers */
+		search(root, &stats);
+	}
+
+	if (g_search_stats)
+		write_search_stats(stderr, &stats);
+
+	/* release the move graph */
+	free(g_counts);
+	free_move_graph(&g_graph);
 
 	/* We're done */
 	return 0;
@@ -85,100 +170,156 @@ void write_summary(time_t start_time)
 	if (g_output_counter == 1)
 		printf("Found one phone number in %s\n", duration_str);
 	else
-		printf("Found %.0lf phone numbers in %s\n", g_output_counter, duration_str);
+		printf("Found %llu phone numbers in %s\n", (unsigned long long)g_output_counter, duration_str);
 
 	return;
 }
 
 /*
-	void output_moves(int current_piece, coor * current_square, int current_digit)
-	follows all the available routes that current_piece can take from current_square,
-	and outputs the resulting phone numbers
+	int open_output(int root)
+	sends the output to the --output file, if there is one, and when
+	resuming cuts it back to the last checkpoint and sets
+	g_output_counter to the numbers already written. If there is no
+	checkpoint yet the search starts from the beginning.
+	returns FALSE if the output or checkpoint cannot be used.
 */
-void output_moves(int current_piece, coor *current_square, int current_digit)
+int open_output(int root)
 {
-	/* set this key in the output string and move on to the next digit */
-	g_output[current_digit] = KeyPad[current_square->x][current_square->y];
+	checkpoint_rec saved;
+	struct stat info;
+	char number[PHONENO_LENGTH_MAX + 1];
+	uint64_t total = graph_count(&g_graph, g_counts, root, g_phoneno_length);
 
-	/* if we have reached the required length then output the string 
-	   otherwise continue moving around the keypad */
-	if (current_digit == g_phoneno_length - 1)
-		write_phoneno();
+	if (g_output_file == NULL)
+		return TRUE;
+
+	/* a job stopped before its first checkpoint just starts again */
+	if (g_resume && (access(g_checkpoint_file, F_OK) != 0) && (errno == ENOENT))
+	{
+		fprintf(stderr, "No checkpoint %s, starting from the beginning\n", g_checkpoint_file);
+		g_resume = FALSE;
+	}
+
+	if (!g_resume)
+	{
+		if (freopen(g_output_file, "w", stdout) == NULL)
+		{
+			fprintf(stderr, "Cannot open %s\n", g_output_file);
+			return FALSE;
+		}
+	}
 	else
-		next_move(current_piece, current_square, current_digit);
+	{
+		if (!read_checkpoint(g_checkpoint_file, &saved))
+		{
+			fprintf(stderr, "Cannot read checkpoint %s\n", g_checkpoint_file);
+			return FALSE;
+		}
 
-	return;
+		/* make sure it is the same search, and the position is in it */
+		if ((strcmp(saved.piece, g_piece_arg) != 0) || (saved.key != g_start_key) ||
+			(saved.length != g_phoneno_length) || (saved.sorted != g_sorted) || (saved.rank > total) ||
+			(saved.offset != saved.rank * (g_phoneno_length + 1)))
+		{
+			fprintf(stderr, "Checkpoint %s is not for this search\n", g_checkpoint_file);
+			return FALSE;
+		}
+
+		if (!saved.complete && (!graph_unrank(&g_graph, g_counts, root, g_phoneno_length, saved.rank, number) ||
+								(strncmp(number, saved.prefix, strlen(saved.prefix)) != 0)))
+		{
+			fprintf(stderr, "Checkpoint %s is not for this search\n", g_checkpoint_file);
+			return FALSE;
+		}
+
+		/* throw away anything written after the checkpoint, which
+		   must all still be there */
+		if ((freopen(g_output_file, "r+", stdout) == NULL) || (fstat(fileno(stdout), &info) != 0) ||
+			((uint64_t)info.st_size < saved.offset) ||
+			(ftruncate(fileno(stdout), saved.offset) != 0) ||
+			(fseeko(stdout, saved.offset, SEEK_SET) != 0))
+		{
+			fprintf(stderr, "Cannot resume %s\n", g_output_file);
+			return FALSE;
+		}
+
+		g_output_counter = saved.rank;
+	}
+
+	if ((g_checkpoint_file != NULL) && !start_checkpoint_timer(g_checkpoint_interval))
+	{
+		fprintf(stderr, "Cannot start checkpoint timer\n");
+		return FALSE;
+	}
+	return TRUE;
 }
 
 /*
-	void next_move( int current_piece, coor * current_square, int current_digit )
-	outputs all the remaining combinations for the current starting digits
+	int store_numbers(int root)
+	writes the phone numbers starting on root to the --store file
+	instead of stdout, in numerical order rather than the search order.
+	returns FALSE if the store cannot be written.
 */
-void next_move(int current_piece, coor *current_square, int current_digit)
+int store_numbers(int root)
 {
-	int i;
-	available_squares_rec *available;
-
-	current_digit++;
-
-	/* If we started with a pawn they can change into other pieces.. */
-	current_piece = reevaluate_piece(current_piece, current_square, current_digit);
+	int ok;
 
-	/* Staying in the same place is a valid move */
-	output_moves(current_piece, current_square, current_digit);
+	if (g_progress_interval > 0)
+		start_progress(&g_output_counter, graph_count(&g_graph, g_counts, root, g_phoneno_length),
+					   g_progress_interval, g_status_file);
 
-	/* Get a record containing the squares available to this piece from here */
-	available = get_available_squares(current_square, current_piece);
+	ok = write_result_store(g_store_file, g_piece_arg, g_start_key, g_phoneno_length, &g_output_counter);
+	stop_progress();
 
-	/* And follow each of them */
-	for (i = 0; i < available->count; i++)
-		if (contains_digit(available->squares + i))
-			output_moves(current_piece, available->squares + i, current_digit);
+	if (!ok)
+		printf("Failed to write store %s\n", g_store_file);
 
-	return;
+	return ok;
 }
 
 /*
-	int reevaluate_piece( int current_piece, coor current_square, int current_digit )
-	Unless the piece is a pawn this will return current_piece
-	When called with a pawn, will return either CP_PAWN, CP_PAWN_SPECIAL or CP_QUEEN, 
-	according tothe following rules:
-	- When a pawn reaches the top row it become a queen.
-	- For the case where the piece is a pawn, starting on one of the bottom 2 rows,
-	  the Pawn may move either one or two spaces forward the first time it moves
+	void search(int root, search_stats * stats)
+	outputs all the phone numbers starting on root, or carries on from
+	where a resumed search left off. For --stats the search is timed,
+	then run again without any output to split the time between
+	searching and writing the numbers out, so that it costs nothing when
+	the stats are not wanted. A resumed search skips the same numbers
+	the second time, so that both runs cover the same part of it.
+	Progress reporting and checkpoints stop once the numbers have been
+	written.
 */
-int reevaluate_piece(int current_piece, coor *current_square, int current_digit)
+void search(int root, search_stats *stats)
 {
-	if (current_piece == CP_PAWN)
-	{
-		/* If a pawn starts on the first 2 rows it can move 2 spaces on it's
-		   first move so upgrade it to CP_PAWN_SPECIAL */
-		if ((current_digit == 1) && (current_square->y < 2))
-			return CP_PAWN_SPECIAL;
+	uint64_t start, total, skip, emitted;
 
-		/* if pawn reaches final row upgrade it to queen */
-		if (current_square->y == KEYPAD_HEIGHT - 1)
-			return CP_QUEEN;
-	}
-	else if (current_piece == CP_PAWN_SPECIAL)
+	skip = g_output_counter;
+	start = clock_ns();
+	resume_moves(root, 0, skip);
+	fflush(stdout);
+	total = clock_ns() - start;
+
+	stop_progress();
+
+	if (g_checkpoint_file != NULL)
 	{
-		/* the pawn can only moves 2 spaces for it's first move at most */
-		if (current_digit >= 2)
-			return CP_PAWN;
+		stop_checkpoint_timer();
+		save_position(-1, TRUE);
 	}
-	return current_piece;
-}
 
-/*
-	void write_phoneno()
-	outputs the current phone number to stdout
-*/
-void write_phoneno(void)
-{
-	if (!g_output_summary)
-		printf("%s\n", g_output);
+	if (!g_search_stats)
+		return;
 
-	g_output_counter += 1;
+	emitted = g_output_counter;
+	g_output_counter = skip;
+	g_output_summary = TRUE;
+	start = clock_ns();
+	resume_moves(root, 0, skip);
+	stats->search_ns = clock_ns() - start;
+	stats->output_ns = (total > stats->search_ns) ? total - stats->search_ns : 0;
+
+	g_output_summary = FALSE;
+	g_output_counter = emitted;
+	return;
 }
 
 /*
@@ -187,16 +328,93 @@ void write_phoneno(void)
 */
 void display_usage(char *program_name)
 {
-	printf("Usage %s <chess_piece> <start_key> [ <phone_no_length> <summarise> ]\n", program_name);
+	printf("Usage %s [ --stats ] [ --progress[=<seconds>] ] [ --status-file=<file> ]\n", program_name);
+	printf("      [ --output=<file> [ --checkpoint=<file> [ --checkpoint-interval=<seconds> ] [ --resume ] ] ]\n");
+	printf("      [ --store=<file> ] [ --sorted ]\n");
+	printf("      <chess_piece> <start_key> [ <phone_no_length> <summarise> ]\n");
+	printf("<chess_piece> is king, queen, bishop, knight, rook, pawn, underpawn or a piece definition\n");
+	printf("  eg. \"nightrider: leap:2,1,*\", or a relay of pieces taking turns, eg. knight/bishop\n");
 }
 
 /*
-	int process_args(int argc, char* argv[], int * piece, coor * start_square)
+	int process_args(int argc, char* argv[], piece_def * piece, coor * start_square)
 	get the starting square and the starting piece from the input parameters
 	return true only if the inputs are valid
 */
-int process_args(int argc, char *argv[], int *piece, coor *start_square)
+int process_args(int argc, char *argv[], piece_def *piece, coor *start_square)
 {
+	int i, count;
+
+	/* pick out the options, leaving the other arguments in order */
+	for (i = 1, count = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--stats") == 0)
+			g_search_stats = TRUE;
+		else if (strcmp(argv[i], "--progress") == 0)
+			g_progress_interval = PROGRESS_INTERVAL_DEF;
+		else if (strncmp(argv[i], "--progress=", 11) == 0)
+		{
+			g_progress_interval = atoi(argv[i] + 11);
+			if (g_progress_interval < 1)
+			{
+				printf("Progress interval must be at least 1 second\n");
+				return FALSE;
+			}
+		}
+		else if (strncmp(argv[i], "--status-file=", 14) == 0)
+		{
+			g_status_file = argv[i] + 14;
+			if (g_progress_interval == 0)
+				g_progress_interval = PROGRESS_INTERVAL_DEF;
+		}
+		else if (strncmp(argv[i], "--output=", 9) == 0)
+			g_output_file = argv[i] + 9;
+		else if (strncmp(argv[i], "--store=", 8) == 0)
+			g_store_file = argv[i] + 8;
+		else if (strncmp(argv[i], "--checkpoint=", 13) == 0)
+			g_checkpoint_file = argv[i] + 13;
+		else if (strncmp(argv[i], "--checkpoint-interval=", 22) == 0)
+		{
+			g_checkpoint_interval = atof(argv[i] + 22);
+			if (!(g_checkpoint_interval > 0))
+			{
+				printf("Checkpoint interval must be more than 0 seconds\n");
+				return FALSE;
+			}
+		}
+		else if (strcmp(argv[i], "--resume") == 0)
+			g_resume = TRUE;
+		else if (strcmp(argv[i], "--sorted") == 0)
+			g_sorted = TRUE;
+		else if (strncmp(argv[i], "--", 2) == 0)
+		{
+			printf("Unknown option %s\n", argv[i]);
+			return FALSE;
+		}
+		else
+			argv[count++] = argv[i];
+	}
+	argc = count;
+
+	/* a checkpoint is only any use if the output can be cut back to it */
+	if ((g_checkpoint_file != NULL) && (g_output_file == NULL))
+	{
+		printf("--checkpoint needs --output\n");
+		return FALSE;
+	}
+
+	if ((g_store_file != NULL) && (g_output_file != NULL))
+	{
+		printf("--store cannot be used with --output\n");
+		return FALSE;
+	}
+
+	if (g_resume && (g_checkpoint_file == NULL))
+	{
+		printf("--resume needs --checkpoint\n");
+		return FALSE;
+	}
+
 	/* We need piece and start square at least */
 	if (argc < 3)
 	{
@@ -205,15 +423,15 @@ int process_args(int argc, char *argv[], int *piece, coor *start_square)
 	}
 
 	/* Get the starting piece */
-	*piece = str_to_piece(argv[1]);
-
-	if (*piece == -1)
+	g_piece_arg = argv[1];
+	if (!get_piece_def(argv[1], piece))
 	{
 		printf("Invalid starting piece\n");
 		return FALSE;
 	}
 
 	/* Get the starting key */
+	g_start_key = argv[2][0];
 	*start_square = key_to_square(argv[2][0]);
 
 	if ((start_square->x < 0) || (start_square->y < 0))
@@ -0,0 +1,143 @@
+/****************************************************************************
+* Name:    chesspadc.c
+*
+* Creator: Frank Wallis
+* Purpose: Sends requests to chesspadd. Each line of stdin is sent to the
+*          server on the socket, and its replies are written to stdout
+*          until it closes the connection, so that requests can come
+*          from a script or a file, eg.
+*
+*            echo "COUNT 5 10 queen" | ./chesspadc /tmp/chesspad.sock
+*
+* History: 18/10/2026	FW	Created.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "stdtypes.h"
+
+/* prototypes */
+
+int connect_server(char *socket_path);
+int relay(int server);
+void display_usage(char *program_name);
+
+int main(int argc, char *argv[])
+{
+	int server;
+
+	if (argc < 2)
+	{
+		display_usage(argv[0]);
+		return 1;
+	}
+
+	if ((server = connect_server(argv[1])) < 0)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	/* the server closes the connection once it has answered everything */
+	if (!relay(server))
+	{
+		fprintf(stderr, "Lost the connection to %s\n", argv[1]);
+		close(server);
+		return 1;
+	}
+
+	close(server);
+	return 0;
+}
+
+/*
+	int connect_server(char * socket_path)
+	returns a socket connected to the server, or -1 if it cannot connect
+*/
+int connect_server(char *socket_path)
+{
+	struct sockaddr_un address;
+	int server;
+
+	if (strlen(socket_path) >= sizeof(address.sun_path))
+		return -1;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+
+	server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((server >= 0) && (connect(server, (struct sockaddr *)&address, sizeof(address)) != 0))
+	{
+		close(server);
+		return -1;
+	}
+
+	return server;
+}
+
+/*
+	int relay(int server)
+	sends stdin to the server and writes its replies to stdout, until
+	it closes the connection. Both are done as they become ready, so a
+	long reply cannot hold up the requests behind it, or the other way
+	round. returns FALSE if the connection or stdout fails.
+*/
+int relay(int server)
+{
+	struct pollfd fds[2];
+	char buffer[4096];
+	ssize_t n, sent, written;
+
+	fds[0].fd = server;
+	fds[0].events = POLLIN;
+	fds[1].fd = STDIN_FILENO;
+	fds[1].events = POLLIN;
+
+	while (TRUE)
+	{
+		if (poll(fds, (fds[1].fd < 0) ? 1 : 2, -1) < 0)
+			return FALSE;
+
+		/* the replies, until the server closes the connection */
+		if (fds[0].revents != 0)
+		{
+			if ((n = read(server, buffer, sizeof(buffer))) < 0)
+				return FALSE;
+			if (n == 0)
+				return (fflush(stdout) == 0);
+			if (fwrite(buffer, 1, n, stdout) != n)
+				return FALSE;
+		}
+
+		/* and the requests, telling the server when there are no more */
+		if ((fds[1].fd >= 0) && (fds[1].revents != 0))
+		{
+			if ((n = read(STDIN_FILENO, buffer, sizeof(buffer))) < 0)
+				return FALSE;
+
+			for (sent = 0; sent < n; sent += written)
+				if ((written = write(server, buffer + sent, n - sent)) <= 0)
+					return FALSE;
+
+			if ((n == 0) && (shutdown(server, SHUT_WR) != 0))
+				return FALSE;
+			if (n == 0)
+				fds[1].fd = -1;
+		}
+	}
+}
+
+/*
+	void display_usage(char * program_name)
+	show accepted command line args
+*/
+void display_usage(char *program_name)
+{
+	printf("Usage %s <socket_path> < <requests>\n", program_name);
+}
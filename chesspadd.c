@@ -0,0 +1,614 @@
+/****************************************************************************
+* Name:    chesspadd.c
+*
+* Creator: Frank Wallis
+* Purpose: Serves chesspad queries over a Unix domain socket, keeping the
+*          move graph and count table for each piece in memory between
+*          requests. Each connection is served by its own thread and
+*          sends one request per line:
+*
+*            COUNT <start_key> <length> <chess_piece>
+*            RANGE <start_key> <length> <first> <count> <chess_piece>
+*            SAMPLE <start_key> <length> <count> <chess_piece>
+*            MEMBER <phone_no> <chess_piece>
+*            QUIT
+*
+*          <chess_piece> is the rest of the line, so it may be a piece
+*          definition. Positions in a RANGE count from 0 in the order
+*          chesspad writes the numbers. Replies are 'OK <result>',
+*          followed for RANGE and SAMPLE by one number per line, or
+*          'ERR <reason>'. The most recently used pieces are kept
+*          compiled.
+*
+* History: 18/10/2026	FW	Created.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "stdtypes.h"
+#include "keypad.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "move_graph.h"
+
+#define MAX_CACHED_PIECES 256
+#define REQUEST_MAX (PIECE_DEF_MAX + 128)
+#define SAMPLE_MAX 1000000
+
+/* a compiled piece, which stays in memory until it is the least
+   recently used of MAX_CACHED_PIECES and another is needed. users
+   counts the requests using it, plus one while it is in g_pieces, and
+   it is freed when that reaches 0 */
+typedef struct
+{
+	char piece[PIECE_DEF_MAX];
+	move_graph graph;
+	uint64_t *counts;
+	int users;
+	uint64_t last_used;
+} piece_rec;
+
+/* prototypes */
+
+void *serve_client(void *arg);
+void handle_request(char *request, FILE *out, uint64_t *seed);
+void count_request(char *args, FILE *out);
+void range_request(char *args, FILE *out);
+void sample_request(char *args, FILE *out, uint64_t *seed);
+void member_request(char *args, FILE *out);
+piece_rec *find_piece(char *piece, FILE *out);
+piece_rec *lookup_piece(char *piece);
+piece_rec *compile_piece(char *piece);
+void evict_piece(void);
+void release_piece(piece_rec *rec);
+void normalise_piece(char *piece);
+int find_root(piece_rec *rec, char key, int length, FILE *out);
+uint64_t random_below(uint64_t *seed, uint64_t limit);
+void preload_pieces(void);
+void shutdown_server(int signal);
+void display_usage(char *program_name);
+
+/* globals */
+
+static piece_rec *g_pieces[MAX_CACHED_PIECES];
+static int g_piece_count = 0;
+static uint64_t g_piece_clock = 0;
+static pthread_rwlock_t g_pieces_lock = PTHREAD_RWLOCK_INITIALIZER;
+static char *g_socket_path;
+
+int main(int argc, char *argv[])
+{
+	struct sockaddr_un address;
+	pthread_t thread;
+	int server, client;
+
+	if (argc < 2)
+	{
+		display_usage(argv[0]);
+		return 1;
+	}
+
+	g_socket_path = argv[1];
+	if (strlen(g_socket_path) >= sizeof(address.sun_path))
+	{
+		printf("Socket path is too long\n");
+		return 1;
+	}
+
+	/* a client going away should not take the server with it */
+	signal(SIGPIPE, SIG_IGN);
+	signal(SIGINT, shutdown_server);
+	signal(SIGTERM, shutdown_server);
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, g_socket_path);
+	unlink(g_socket_path);
+
+	server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((server < 0) || (bind(server, (struct sockaddr *)&address, sizeof(address)) != 0) ||
+		(listen(server, SOMAXCONN) != 0))
+	{
+		perror(g_socket_path);
+		return 1;
+	}
+
+	/* have the standard pieces ready before the first request */
+	preload_pieces();
+
+	while (TRUE)
+	{
+		client = accept(server, NULL, NULL);
+		if (client < 0)
+			continue;
+
+		if (pthread_create(&thread, NULL, serve_client, (void *)(intptr_t)client) != 0)
+		{
+			close(client);
+			continue;
+		}
+		pthread_detach(thread);
+	}
+
+	return 0;
+}
+
+/*
+	void * serve_client(void * arg)
+	answers each request from a connection until it closes or sends QUIT
+*/
+void *serve_client(void *arg)
+{
+	int client = (int)(intptr_t)arg;
+	char request[REQUEST_MAX];
+	uint64_t seed;
+	FILE *in, *out;
+
+	in = fdopen(client, "r");
+	out = fdopen(dup(client), "w");
+
+	if ((in == NULL) || (out == NULL))
+	{
+		if (in != NULL)
+			fclose(in);
+		else
+			close(client);
+		return NULL;
+	}
+
+	/* every connection gets its own random numbers for SAMPLE */
+	seed = ((uint64_t)time(NULL) << 20) ^ ((uint64_t)client << 8) ^ (uintptr_t)&seed ^ 1;
+
+	while (fgets(request, sizeof(request), in) != NULL)
+	{
+		request[strcspn(request, "\r\n")] = '\0';
+
+		if (strcasecmp(request, "QUIT") == 0)
+			break;
+
+		handle_request(request, out, &seed);
+
+		/* give up on a client which has gone away */
+		if ((fflush(out) != 0) || ferror(out))
+			break;
+	}
+
+	fclose(in);
+	fclose(out);
+	return NULL;
+}
+
+/*
+	void handle_request(char * request, FILE * out, uint64_t * seed)
+	works out which request this is and answers it
+*/
+void handle_request(char *request, FILE *out, uint64_t *seed)
+{
+	char *args = request + strcspn(request, " \t");
+
+	if (*args != '\0')
+		*args++ = '\0';
+
+	if (strcasecmp(request, "COUNT") == 0)
+		count_request(args, out);
+	else if (strcasecmp(request, "RANGE") == 0)
+		range_request(args, out);
+	else if (strcasecmp(request, "SAMPLE") == 0)
+		sample_request(args, out, seed);
+	else if (strcasecmp(request, "MEMBER") == 0)
+		member_request(args, out);
+	else
+		fprintf(out, "ERR Unknown request\n");
+
+	return;
+}
+
+/*
+	void count_request(char * args, FILE * out)
+	COUNT <start_key> <length> <chess_piece>
+*/
+void count_request(char *args, FILE *out)
+{
+	piece_rec *rec;
+	char key;
+	int length, used, root;
+
+	if (sscanf(args, " %c %d %n", &key, &length, &used) != 2)
+	{
+		fprintf(out, "ERR Usage COUNT <start_key> <length> <chess_piece>\n");
+		return;
+	}
+
+	if ((rec = find_piece(args + used, out)) == NULL)
+		return;
+
+	if ((root = find_root(rec, key, length, out)) != -1)
+		fprintf(out, "OK %llu\n", (unsigned long long)graph_count(&rec->graph, rec->counts, root, length));
+
+	release_piece(rec);
+	return;
+}
+
+/*
+	void range_request(char * args, FILE * out)
+	RANGE <start_key> <length> <first> <count> <chess_piece>
+	writes up to count numbers, starting at position first
+*/
+void range_request(char *args, FILE *out)
+{
+	char number[PHONENO_LENGTH_MAX + 1];
+	unsigned long long first, count;
+	graph_cursor cursor;
+	piece_rec *rec;
+	uint64_t total;
+	char key;
+	int length, used, root;
+
+	if (sscanf(args, " %c %d %llu %llu %n", &key, &length, &first, &count, &used) != 4)
+	{
+		fprintf(out, "ERR Usage RANGE <start_key> <length> <first> <count> <chess_piece>\n");
+		return;
+	}
+
+	if ((rec = find_piece(args + used, out)) == NULL)
+		return;
+
+	if ((root = find_root(rec, key, length, out)) == -1)
+	{
+		release_piece(rec);
+		return;
+	}
+
+	total = graph_count(&rec->graph, rec->counts, root, length);
+	if (first >= total)
+		count = 0;
+	else if (count > total - first)
+		count = total - first;
+
+	fprintf(out, "OK %llu\n", count);
+
+	/* stop if the client goes away rather than running on to the end */
+	if ((count > 0) && start_cursor(&cursor, &rec->graph, rec->counts, root, length, first))
+		while ((count-- > 0) && next_number(&cursor, number))
+			if ((fprintf(out, "%s\n", number) < 0) || ferror(out))
+				break;
+
+	release_piece(rec);
+	return;
+}
+
+/*
+	void sample_request(char * args, FILE * out, uint64_t * seed)
+	SAMPLE <start_key> <length> <count> <chess_piece>
+	writes count (up to SAMPLE_MAX) numbers picked at random, each
+	equally likely
+*/
+void sample_request(char *args, FILE *out, uint64_t *seed)
+{
+	char number[PHONENO_LENGTH_MAX + 1];
+	unsigned long long count;
+	piece_rec *rec;
+	uint64_t total;
+	char key;
+	int length, used, root;
+
+	if (sscanf(args, " %c %d %llu %n", &key, &length, &count, &used) != 3)
+	{
+		fprintf(out, "ERR Usage SAMPLE <start_key> <length> <count> <chess_piece>\n");
+		return;
+	}
+
+	if (count > SAMPLE_MAX)
+	{
+		fprintf(out, "ERR SAMPLE count must be at most %d\n", SAMPLE_MAX);
+		return;
+	}
+
+	if ((rec = find_piece(args + used, out)) == NULL)
+		return;
+
+	if ((root = find_root(rec, key, length, out)) == -1)
+	{
+		release_piece(rec);
+		return;
+	}
+
+	total = graph_count(&rec->graph, rec->counts, root, length);
+	fprintf(out, "OK %llu\n", count);
+
+	while (count-- > 0)
+	{
+		graph_unrank(&rec->graph, rec->counts, root, length, random_below(seed, total), number);
+		if ((fprintf(out, "%s\n", number) < 0) || ferror(out))
+			break;
+	}
+
+	release_piece(rec);
+	return;
+}
+
+/*
+	void member_request(char * args, FILE * out)
+	MEMBER <phone_no> <chess_piece>
+	replies 'OK 1 <position>' if the piece can dial the number, or 'OK 0'
+*/
+void member_request(char *args, FILE *out)
+{
+	char number[PHONENO_LENGTH_MAX + 2];
+	piece_rec *rec;
+	uint64_t rank;
+	int length, used, root;
+
+	if (sscanf(args, " %16s %n", number, &used) != 1)
+	{
+		fprintf(out, "ERR Usage MEMBER <phone_no> <chess_piece>\n");
+		return;
+	}
+
+	/* a longer number is cut off one character past the limit */
+	length = strlen(number);
+	if (length > PHONENO_LENGTH_MAX)
+	{
+		fprintf(out, "ERR Phone numbers must be between 1 and %d digits long\n", PHONENO_LENGTH_MAX);
+		return;
+	}
+
+	if ((rec = find_piece(args + used, out)) == NULL)
+		return;
+
+	root = find_root(rec, number[0], length, out);
+
+	if ((root != -1) && graph_rank(&rec->graph, rec->counts, root, length, number, &rank))
+		fprintf(out, "OK 1 %llu\n", (unsigned long long)rank);
+	else if (root != -1)
+		fprintf(out, "OK 0\n");
+
+	release_piece(rec);
+	return;
+}
+
+/*
+	piece_rec * find_piece(char * piece, FILE * out)
+	returns the compiled piece, compiling it the first time it is asked
+	for, which the caller must release_piece when it has finished with.
+	replies with an error and returns NULL if it is not valid.
+*/
+piece_rec *find_piece(char *piece, FILE *out)
+{
+	piece_rec *rec;
+
+	normalise_piece(piece);
+
+	if ((piece[0] == '\0') || (strlen(piece) >= PIECE_DEF_MAX))
+	{
+		fprintf(out, "ERR Invalid chess piece\n");
+		return NULL;
+	}
+
+	/* usually it is already there, and any number of threads can look */
+	pthread_rwlock_rdlock(&g_pieces_lock);
+	rec = lookup_piece(piece);
+	pthread_rwlock_unlock(&g_pieces_lock);
+
+	if (rec != NULL)
+		return rec;
+
+	/* otherwise compile it, unless another thread has got there first */
+	pthread_rwlock_wrlock(&g_pieces_lock);
+	rec = lookup_piece(piece);
+
+	if (rec == NULL)
+		rec = compile_piece(piece);
+
+	pthread_rwlock_unlock(&g_pieces_lock);
+
+	if (rec == NULL)
+		fprintf(out, "ERR Invalid chess piece\n");
+
+	return rec;
+}
+
+/*
+	piece_rec * lookup_piece(char * piece)
+	returns the piece if it has already been compiled, marking it used,
+	or NULL. g_pieces_lock must be held, for reading at least.
+*/
+piece_rec *lookup_piece(char *piece)
+{
+	int i;
+
+	for (i = 0; i < g_piece_count; i++)
+	{
+		if (strcmp(g_pieces[i]->piece, piece) == 0)
+		{
+			__atomic_add_fetch(&g_pieces[i]->users, 1, __ATOMIC_RELAXED);
+			__atomic_store_n(&g_pieces[i]->last_used, __atomic_add_fetch(&g_piece_clock, 1, __ATOMIC_RELAXED),
+							 __ATOMIC_RELAXED);
+			return g_pieces[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+	piece_rec * compile_piece(char * piece)
+	compiles the piece and adds it to g_pieces, making room if need be.
+	returns NULL if it is not valid. g_pieces_lock must be held for
+	writing; the def is static to keep it off the stack, so this is
+	under the lock.
+*/
+piece_rec *compile_piece(char *piece)
+{
+	static piece_def def;
+	piece_rec *rec;
+
+	rec = calloc(1, sizeof(piece_rec));
+
+	if ((rec == NULL) || !get_piece_def(piece, &def) || !build_move_graph(&def, &rec->graph) ||
+		((rec->counts = build_count_table(&rec->graph, PHONENO_LENGTH_MAX)) == NULL))
+	{
+		if (rec != NULL)
+			free_move_graph(&rec->graph);
+		free(rec);
+		return NULL;
+	}
+
+	if (g_piece_count == MAX_CACHED_PIECES)
+		evict_piece();
+
+	/* one user for g_pieces, and one for the caller */
+	strcpy(rec->piece, piece);
+	rec->users = 2;
+	rec->last_used = __atomic_add_fetch(&g_piece_clock, 1, __ATOMIC_RELAXED);
+	g_pieces[g_piece_count++] = rec;
+	return rec;
+}
+
+/*
+	void evict_piece(void)
+	takes the least recently used piece out of g_pieces. Requests still
+	using it keep it until they release it. g_pieces_lock must be held
+	for writing.
+*/
+void evict_piece(void)
+{
+	int i, oldest = 0;
+
+	for (i = 1; i < g_piece_count; i++)
+		if (__atomic_load_n(&g_pieces[i]->last_used, __ATOMIC_RELAXED) <
+			__atomic_load_n(&g_pieces[oldest]->last_used, __ATOMIC_RELAXED))
+			oldest = i;
+
+	release_piece(g_pieces[oldest]);
+	g_pieces[oldest] = g_pieces[--g_piece_count];
+	return;
+}
+
+/*
+	void release_piece(piece_rec * rec)
+	finishes with a piece from find_piece, freeing it if it has been
+	evicted and nothing else is using it
+*/
+void release_piece(piece_rec *rec)
+{
+	if (__atomic_sub_fetch(&rec->users, 1, __ATOMIC_ACQ_REL) != 0)
+		return;
+
+	free(rec->counts);
+	free_move_graph(&rec->graph);
+	free(rec);
+	return;
+}
+
+/*
+	void normalise_piece(char * piece)
+	lowercases the piece, as names and definitions are not case
+	sensitive, and trims it and squeezes runs of spaces to one, so that
+	the same piece always has the same entry in g_pieces
+*/
+void normalise_piece(char *piece)
+{
+	char *to = piece, *from;
+
+	for (from = piece; *from != '\0'; from++)
+	{
+		if (!isspace((unsigned char)*from))
+			*to++ = tolower((unsigned char)*from);
+		else if ((to > piece) && (to[-1] != ' ') && (from[1] != '\0') && !isspace((unsigned char)from[1]))
+			*to++ = ' ';
+	}
+	*to = '\0';
+	return;
+}
+
+/*
+	int find_root(piece_rec * rec, char key, int length, FILE * out)
+	returns the node the piece starts on for key, checking the length
+	too. replies with an error and returns -1 if either is not valid.
+*/
+int find_root(piece_rec *rec, char key, int length, FILE *out)
+{
+	coor square = key_to_square(key);
+
+	if ((square.x < 0) || (square.y < 0) || !contains_digit(&square))
+	{
+		fprintf(out, "ERR Invalid starting key\n");
+		return -1;
+	}
+
+	if ((length < 1) || (length > PHONENO_LENGTH_MAX))
+	{
+		fprintf(out, "ERR Phone numbers must be between 1 and %d digits long\n", PHONENO_LENGTH_MAX);
+		return -1;
+	}
+
+	return graph_root(&rec->graph, &square);
+}
+
+/*
+	uint64_t random_below(uint64_t * seed, uint64_t limit)
+	returns a random number from 0 to limit - 1 (xorshift64*), rejecting
+	the values which would make some results more likely than others
+*/
+uint64_t random_below(uint64_t *seed, uint64_t limit)
+{
+	uint64_t value, ceiling = UINT64_MAX - (UINT64_MAX % limit);
+
+	do
+	{
+		*seed ^= *seed >> 12;
+		*seed ^= *seed << 25;
+		*seed ^= *seed >> 27;
+		value = *seed * 0x2545F4914F6CDD1DULL;
+	} while (value >= ceiling);
+
+	return value % limit;
+}
+
+/*
+	void preload_pieces(void)
+	compiles the standard pieces
+*/
+void preload_pieces(void)
+{
+	char *names[] = {"king", "queen", "bishop", "knight", "rook", "pawn", "underpawn"};
+	char name[PIECE_NAME_MAX];
+	piece_rec *rec;
+	int i;
+
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+	{
+		strcpy(name, names[i]);
+		if ((rec = find_piece(name, stderr)) != NULL)
+			release_piece(rec);
+	}
+	return;
+}
+
+/*
+	void shutdown_server(int signal)
+	removes the socket on the way out
+*/
+void shutdown_server(int signal)
+{
+	unlink(g_socket_path);
+	_exit(0);
+}
+
+/*
+	void display_usage(char * program_name)
+	show accepted command line args
+*/
+void display_usage(char *program_name)
+{
+	printf("Usage %s <socket_path>\n", program_name);
+}
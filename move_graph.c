@@ -0,0 +1,486 @@
+/*****************************************************************
+* Name:    move_graph.c
+*
+* Creator: Frank Wallis
+* Purpose: Compiles a piece definition into a flat graph of
+*          (square, piece states) nodes on the keypad, with the
+*          successors of each node precalculated, so that the search
+*          never has to work out moves or piece changes as it goes.
+*          Where a piece can choose between states (eg. promoting a
+*          pawn) the node holds the set of states it could be in, so
+*          that each path through the graph is a different number.
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stdtypes.h"
+#include "keypad.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "move_graph.h"
+
+#define NUM_SQUARES (KEYPAD_WIDTH * KEYPAD_HEIGHT)
+
+/* prototypes */
+int build_move_graph(piece_def *def, move_graph *graph);
+void free_move_graph(move_graph *graph);
+int graph_root(move_graph *graph, coor *square);
+void sort_successors(move_graph *graph);
+uint64_t *build_count_table(move_graph *graph, int max_length);
+uint64_t graph_count(move_graph *graph, uint64_t *counts, int node, int length);
+int graph_unrank(move_graph *graph, uint64_t *counts, int root, int length, uint64_t rank, char *number);
+int graph_rank(move_graph *graph, uint64_t *counts, int root, int length, char *number, uint64_t *rank);
+int start_cursor(graph_cursor *cursor, move_graph *graph, uint64_t *counts, int root, int length, uint64_t rank);
+int next_number(graph_cursor *cursor, char *number);
+int advance_cursor(graph_cursor *cursor);
+
+int add_successors(piece_def *def, move_graph *graph, int node);
+int add_target(coor *targets, unsigned int *target_states, int count, coor *square, int state);
+int add_node(move_graph *graph, coor *square, unsigned int states);
+
+/*
+	int build_move_graph(piece_def * def, move_graph * graph)
+	builds the graph of every node the piece can reach from any
+	starting key. returns FALSE if it runs out of memory.
+*/
+int build_move_graph(piece_def *def, move_graph *graph)
+{
+	coor square;
+	int i;
+
+	memset(graph, 0, sizeof(move_graph));
+
+	/* the piece starts in its first state on any key with a digit */
+	for (square.x = 0; square.x < KEYPAD_WIDTH; square.x++)
+	{
+		for (square.y = 0; square.y < KEYPAD_HEIGHT; square.y++)
+		{
+			i = (KEYPAD_HEIGHT * square.x) + square.y;
+			graph->roots[i] = contains_digit(&square) ? add_node(graph, &square, 1u) : -1;
+		}
+	}
+
+	/* new nodes are appended as they are found, so this visits them all */
+	for (i = 0; i < graph->node_count; i++)
+	{
+		if (!add_successors(def, graph, i))
+		{
+			free_move_graph(graph);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+	void free_move_graph(move_graph * graph)
+	releases the memory held by the graph
+*/
+void free_move_graph(move_graph *graph)
+{
+	free(graph->nodes);
+	free(graph->succ);
+	memset(graph, 0, sizeof(move_graph));
+	return;
+}
+
+/*
+	int graph_root(move_graph * graph, coor * square)
+	returns the node a piece starts on for this square, or -1
+*/
+int graph_root(move_graph *graph, coor *square)
+{
+	return graph->roots[(KEYPAD_HEIGHT * square->x) + square->y];
+}
+
+/*
+	void sort_successors(move_graph * graph)
+	puts each node's moves in the order of the keys they land on, so
+	that the numbers come out in numerical order rather than the order
+	of the piece's moves
+*/
+void sort_successors(move_graph *graph)
+{
+	int *succ;
+	int node, i, j, next;
+
+	for (node = 0; node < graph->node_count; node++)
+	{
+		succ = graph->succ + graph->nodes[node].first_succ;
+
+		/* there are only a handful of moves from each node */
+		for (i = 1; i < graph->nodes[node].succ_count; i++)
+		{
+			next = succ[i];
+			for (j = i; (j > 0) && (graph->nodes[succ[j - 1]].key > graph->nodes[next].key); j--)
+				succ[j] = succ[j - 1];
+			succ[j] = next;
+		}
+	}
+	return;
+}
+
+/*
+	int add_successors(piece_def * def, move_graph * graph, int node)
+	works out which states the piece moves on in from this node and
+	appends the nodes it can move to. Staying in the same place is
+	always the first of them, followed by the moves of each state in
+	the order of its vectors.
+*/
+int add_successors(piece_def *def, move_graph *graph, int node)
+{
+	coor targets[NUM_SQUARES];
+	unsigned int target_states[NUM_SQUARES];
+	coor square, new_square;
+	unsigned int states = 0;
+	move_vector *vector;
+	int count, hops, s, i, next, rejected = 0;
+	int *succ;
+
+	square = graph->nodes[node].square;
+
+	/* if we started with a pawn it can change into other pieces.. */
+	for (s = 0; s < MAX_PIECE_STATES; s++)
+		if (graph->nodes[node].states & (1u << s))
+			states |= next_piece_states(def, s, &square);
+
+	/* staying in the same place is a valid move */
+	targets[0] = square;
+	target_states[0] = states;
+	count = 1;
+
+	for (s = 0; s < def->state_count; s++)
+	{
+		if (!(states & (1u << s)))
+			continue;
+
+		for (i = 0; i < def->states[s].vector_count; i++)
+		{
+			vector = def->states[s].vectors + i;
+			new_square = square;
+
+			for (hops = vector->max_hops; hops > 0; hops--)
+			{
+				new_square.x += vector->dx;
+				new_square.y += vector->dy;
+
+				/* Are we off the board? */
+				if ((new_square.x < 0) || (new_square.x >= KEYPAD_WIDTH))
+					break;
+
+				if ((new_square.y < 0) || (new_square.y >= KEYPAD_HEIGHT))
+					break;
+
+				if (contains_digit(&new_square))
+					count = add_target(targets, target_states, count, &new_square, s);
+				else
+					rejected++;
+			}
+		}
+	}
+
+	/* now add the nodes, which may move the nodes array */
+	succ = realloc(graph->succ, (graph->succ_total + count) * sizeof(int));
+	if (succ == NULL)
+		return FALSE;
+	graph->succ = succ;
+
+	for (i = 0; i < count; i++)
+	{
+		next = add_node(graph, targets + i, target_states[i]);
+		if (next == -1)
+			return FALSE;
+
+		graph->succ[graph->succ_total + i] = next;
+	}
+
+	graph->nodes[node].next_states = states;
+	graph->nodes[node].first_succ = graph->succ_total;
+	graph->nodes[node].succ_count = count;
+	graph->nodes[node].rejected = rejected;
+	graph->succ_total += count;
+	return TRUE;
+}
+
+/*
+	int add_target(coor * targets, unsigned int * target_states, int count, coor * square, int state)
+	records that state can move to square, and returns the new number of targets
+*/
+int add_target(coor *targets, unsigned int *target_states, int count, coor *square, int state)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		if ((targets[i].x == square->x) && (targets[i].y == square->y))
+		{
+			target_states[i] |= (1u << state);
+			return count;
+		}
+	}
+
+	targets[count] = *square;
+	target_states[count] = (1u << state);
+	return count + 1;
+}
+
+/*
+	int add_node(move_graph * graph, coor * square, unsigned int states)
+	returns the index of the node for this square and set of states,
+	adding it if it is new. returns -1 if it runs out of memory.
+*/
+int add_node(move_graph *graph, coor *square, unsigned int states)
+{
+	graph_node *nodes;
+	int i;
+
+	for (i = 0; i < graph->node_count; i++)
+		if ((graph->nodes[i].states == states) &&
+			(graph->nodes[i].square.x == square->x) && (graph->nodes[i].square.y == square->y))
+			return i;
+
+	/* grow the array in blocks */
+	if (graph->node_count % NUM_SQUARES == 0)
+	{
+		nodes = realloc(graph->nodes, (graph->node_count + NUM_SQUARES) * sizeof(graph_node));
+		if (nodes == NULL)
+			return -1;
+		graph->nodes = nodes;
+	}
+
+	nodes = graph->nodes + graph->node_count;
+	nodes->key = key_for_square(square);
+	nodes->square = *square;
+	nodes->states = states;
+	nodes->next_states = 0;
+	nodes->first_succ = 0;
+	nodes->succ_count = 0;
+	nodes->rejected = 0;
+
+	return graph->node_count++;
+}
+
+/*
+	uint64_t * build_count_table(move_graph * graph, int max_length)
+	returns a table of the number of phone numbers of each length up to
+	max_length which start on each node, or NULL if out of memory.
+	the caller must free it.
+*/
+uint64_t *build_count_table(move_graph *graph, int max_length)
+{
+	uint64_t *counts, *previous, *current;
+	graph_node *node;
+	int length, i, j;
+
+	counts = calloc((max_length + 1) * graph->node_count, sizeof(uint64_t));
+	if (counts == NULL)
+		return NULL;
+
+	/* a single digit is one phone number */
+	for (i = 0; i < graph->node_count; i++)
+		counts[graph->node_count + i] = 1;
+
+	/* and each longer one is the sum of those one shorter from each successor */
+	for (length = 2; length <= max_length; length++)
+	{
+		previous = counts + (length - 1) * graph->node_count;
+		current = counts + length * graph->node_count;
+
+		for (i = 0; i < graph->node_count; i++)
+		{
+			node = graph->nodes + i;
+			for (j = 0; j < node->succ_count; j++)
+				current[i] += previous[graph->succ[node->first_succ + j]];
+		}
+	}
+
+	return counts;
+}
+
+/*
+	uint64_t graph_count(move_graph * graph, uint64_t * counts, int node, int length)
+	looks up the number of phone numbers of length digits starting on node
+*/
+uint64_t graph_count(move_graph *graph, uint64_t *counts, int node, int length)
+{
+	return counts[(length * graph->node_count) + node];
+}
+
+/*
+	int graph_unrank(move_graph * graph, uint64_t * counts, int root, int length, uint64_t rank, char * number)
+	writes the phone number which comes rank'th (from 0) in the search
+	order from root into number. returns FALSE if there are not that many.
+*/
+int graph_unrank(move_graph *graph, uint64_t *counts, int root, int length, uint64_t rank, char *number)
+{
+	graph_node *node;
+	uint64_t count;
+	int digit, i, next = root;
+
+	if (rank >= graph_count(graph, counts, root, length))
+		return FALSE;
+
+	for (digit = 0;; digit++)
+	{
+		node = graph->nodes + root;
+		number[digit] = node->key;
+
+		if (digit == length - 1)
+			break;
+
+		/* pass over the successors whose numbers all come before it */
+		for (i = 0; i < node->succ_count; i++)
+		{
+			next = graph->succ[node->first_succ + i];
+			count = graph_count(graph, counts, next, length - digit - 1);
+
+			if (rank < count)
+				break;
+
+			rank -= count;
+		}
+		root = next;
+	}
+
+	number[length] = '\0';
+	return TRUE;
+}
+
+/*
+	int graph_rank(move_graph * graph, uint64_t * counts, int root, int length, char * number, uint64_t * rank)
+	the reverse of graph_unrank. sets rank to the position of number in
+	the search order from root, and returns FALSE if the piece cannot
+	dial it.
+*/
+int graph_rank(move_graph *graph, uint64_t *counts, int root, int length, char *number, uint64_t *rank)
+{
+	graph_node *node = graph->nodes + root;
+	int digit, i, next = root;
+
+	*rank = 0;
+	if (node->key != number[0])
+		return FALSE;
+
+	for (digit = 1; digit < length; digit++)
+	{
+		/* the successors of a node are all on different keys */
+		for (i = 0; i < node->succ_count; i++)
+		{
+			next = graph->succ[node->first_succ + i];
+			if (graph->nodes[next].key == number[digit])
+				break;
+
+			*rank += graph_count(graph, counts, next, length - digit);
+		}
+
+		if (i == node->succ_count)
+			return FALSE;
+
+		node = graph->nodes + next;
+	}
+	return TRUE;
+}
+
+/*
+	int start_cursor(graph_cursor * cursor, move_graph * graph, uint64_t * counts, int root, int length, uint64_t rank)
+	positions cursor on the phone number which comes rank'th in the
+	search order from root. returns FALSE if there are not that many.
+*/
+int start_cursor(graph_cursor *cursor, move_graph *graph, uint64_t *counts, int root, int length, uint64_t rank)
+{
+	graph_node *node;
+	uint64_t count;
+	int digit, i;
+
+	cursor->graph = graph;
+	cursor->length = length;
+	cursor->finished = TRUE;
+
+	if ((length < 1) || (length > PHONENO_LENGTH_MAX) || (rank >= graph_count(graph, counts, root, length)))
+		return FALSE;
+
+	cursor->path[0] = root;
+
+	for (digit = 0; digit < length - 1; digit++)
+	{
+		node = graph->nodes + cursor->path[digit];
+
+		for (i = 0; i < node->succ_count; i++)
+		{
+			count = graph_count(graph, counts, graph->succ[node->first_succ + i], length - digit - 1);
+			if (rank < count)
+				break;
+
+			rank -= count;
+		}
+
+		cursor->index[digit] = i;
+		cursor->path[digit + 1] = graph->succ[node->first_succ + i];
+	}
+
+	cursor->finished = FALSE;
+	return TRUE;
+}
+
+/*
+	int next_number(graph_cursor * cursor, char * number)
+	writes the number at the cursor into number and moves on to the
+	next one in the search order. returns FALSE when there are no more.
+*/
+int next_number(graph_cursor *cursor, char *number)
+{
+	move_graph *graph = cursor->graph;
+	int digit;
+
+	if (cursor->finished)
+		return FALSE;
+
+	for (digit = 0; digit < cursor->length; digit++)
+		number[digit] = graph->nodes[cursor->path[digit]].key;
+	number[cursor->length] = '\0';
+
+	advance_cursor(cursor);
+	return TRUE;
+}
+
+/*
+	int advance_cursor(graph_cursor * cursor)
+	moves the cursor on to the next number in the search order and
+	returns the first digit which changed, or -1 (and marks the cursor
+	finished) if there are no more.
+*/
+int advance_cursor(graph_cursor *cursor)
+{
+	move_graph *graph = cursor->graph;
+	graph_node *node;
+	int digit, changed;
+
+	/* back up to the last digit with another successor to try */
+	for (digit = cursor->length - 2; digit >= 0; digit--)
+		if (cursor->index[digit] + 1 < graph->nodes[cursor->path[digit]].succ_count)
+			break;
+
+	if (digit < 0)
+	{
+		cursor->finished = TRUE;
+		return -1;
+	}
+
+	/* take it, then the first successor all the way down, as every
+	   node has at least the move of staying where it is */
+	node = graph->nodes + cursor->path[digit];
+	cursor->index[digit]++;
+	cursor->path[digit + 1] = graph->succ[node->first_succ + cursor->index[digit]];
+	changed = digit + 1;
+
+	for (digit++; digit < cursor->length - 1; digit++)
+	{
+		cursor->index[digit] = 0;
+		cursor->path[digit + 1] = graph->succ[graph->nodes[cursor->path[digit]].first_succ];
+	}
+	return changed;
+}
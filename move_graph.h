@@ -0,0 +1,63 @@
+/*****************************************************************
+* Name:    move_graph.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for move_graph.c
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef MOVE_GRAPH_H
+#define MOVE_GRAPH_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	char key;
+	coor square;
+	unsigned int states;
+	unsigned int next_states;
+	int first_succ;
+	int succ_count;
+	int rejected;
+} graph_node;
+
+/* the moves of a piece around the keypad, flattened into a graph of
+   (square, piece states) nodes. next_states are the states the piece
+   moves on in from a node, and rejected counts the moves from it which
+   landed on a square without a digit. roots holds the starting node
+   for each square, or -1 for the squares without a digit */
+typedef struct
+{
+	graph_node *nodes;
+	int node_count;
+	int *succ;
+	int succ_total;
+	int roots[KEYPAD_WIDTH * KEYPAD_HEIGHT];
+} move_graph;
+
+/* a position in the search order of the numbers from a root, for
+   pulling them out one at a time. path holds the node for each digit
+   and index the successor taken from it to reach the next */
+typedef struct
+{
+	move_graph *graph;
+	int length;
+	int finished;
+	int path[PHONENO_LENGTH_MAX];
+	int index[PHONENO_LENGTH_MAX];
+} graph_cursor;
+
+extern int build_move_graph(piece_def *def, move_graph *graph);
+extern void free_move_graph(move_graph *graph);
+extern int graph_root(move_graph *graph, coor *square);
+extern void sort_successors(move_graph *graph);
+extern uint64_t *build_count_table(move_graph *graph, int max_length);
+extern uint64_t graph_count(move_graph *graph, uint64_t *counts, int node, int length);
+extern int graph_unrank(move_graph *graph, uint64_t *counts, int root, int length, uint64_t rank, char *number);
+extern int graph_rank(move_graph *graph, uint64_t *counts, int root, int length, char *number, uint64_t *rank);
+extern int start_cursor(graph_cursor *cursor, move_graph *graph, uint64_t *counts, int root, int length, uint64_t rank);
+extern int next_number(graph_cursor *cursor, char *number);
+extern int advance_cursor(graph_cursor *cursor);
+
+#endif
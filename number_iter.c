@@ -0,0 +1,244 @@
+/*****************************************************************
+* Name:    number_iter.c
+*
+* Creator: Frank Wallis
+* Purpose: Hands out the phone numbers chesspad finds in batches, for
+*          programs which want them without running chesspad. Numbers
+*          come in the same order as chesspad writes them, packed into
+*          a uint64_t as their decimal value, so 0845 is 845 and the
+*          caller pads it back out to the length.
+*
+*          The iterator owns its own move graph and count table, so
+*          any number of them can be used at once from different
+*          threads. Nothing is allocated after it is created.
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "stdtypes.h"
+#include "keypad.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "move_graph.h"
+#include "number_iter.h"
+
+/* prefix holds the packed value of the digits of the cursor's path up
+   to each position, so a batch only does the sums for the digits which
+   have changed */
+struct number_iter
+{
+	move_graph graph;
+	uint64_t *counts;
+	int root;
+	int length;
+	uint64_t total;
+	uint64_t position;
+	graph_cursor cursor;
+	uint64_t prefix[PHONENO_LENGTH_MAX];
+};
+
+/* prototypes */
+number_iter *create_number_iter(const char *piece, char start_key, int length);
+void free_number_iter(number_iter *iter);
+void sort_number_iter(number_iter *iter);
+int seek_number_iter(number_iter *iter, uint64_t position);
+int next_batch(number_iter *iter, uint64_t *buf, int max);
+uint64_t number_iter_position(number_iter *iter);
+uint64_t number_iter_total(number_iter *iter);
+
+void set_prefix(number_iter *iter, int digit);
+
+/*
+	number_iter * create_number_iter(const char * piece, char start_key, int length)
+	returns an iterator over the phone numbers of length digits the
+	piece (a name or a definition) can dial from start_key, positioned
+	at the first of them. returns NULL if any of them is not valid or
+	it runs out of memory.
+*/
+number_iter *create_number_iter(const char *piece, char start_key, int length)
+{
+	char name[PIECE_DEF_MAX];
+	piece_def *def;
+	number_iter *iter;
+	coor square = key_to_square(start_key);
+	int valid;
+
+	if ((square.x < 0) || (square.y < 0) || !contains_digit(&square))
+		return NULL;
+
+	if ((length < 1) || (length > PHONENO_LENGTH_MAX) || (strlen(piece) >= PIECE_DEF_MAX))
+		return NULL;
+
+	iter = calloc(1, sizeof(number_iter));
+	def = malloc(sizeof(piece_def));
+
+	if ((iter == NULL) || (def == NULL))
+	{
+		free(iter);
+		free(def);
+		return NULL;
+	}
+
+	/* get_piece_def lowercases names in place */
+	strcpy(name, piece);
+	valid = get_piece_def(name, def) && build_move_graph(def, &iter->graph);
+	free(def);
+
+	if (valid)
+		iter->counts = build_count_table(&iter->graph, length);
+
+	if (iter->counts == NULL)
+	{
+		free_move_graph(&iter->graph);
+		free(iter);
+		return NULL;
+	}
+
+	iter->root = graph_root(&iter->graph, &square);
+	iter->length = length;
+	iter->total = graph_count(&iter->graph, iter->counts, iter->root, length);
+
+	seek_number_iter(iter, 0);
+	return iter;
+}
+
+/*
+	void free_number_iter(number_iter * iter)
+	releases the iterator and everything it holds
+*/
+void free_number_iter(number_iter *iter)
+{
+	if (iter == NULL)
+		return;
+
+	free(iter->counts);
+	free_move_graph(&iter->graph);
+	free(iter);
+	return;
+}
+
+/*
+	void sort_number_iter(number_iter * iter)
+	makes the iterator return the numbers in numerical order instead of
+	chesspad's, and goes back to the first of them
+*/
+void sort_number_iter(number_iter *iter)
+{
+	sort_successors(&iter->graph);
+	seek_number_iter(iter, 0);
+	return;
+}
+
+/*
+	int seek_number_iter(number_iter * iter, uint64_t position)
+	moves the iterator so that the next number it returns is the one
+	at position (counting from 0), eg. to carry on from where an earlier
+	iterator got to. returns FALSE if there are not that many numbers.
+*/
+int seek_number_iter(number_iter *iter, uint64_t position)
+{
+	if (position > iter->total)
+		return FALSE;
+
+	iter->position = position;
+
+	/* seeking to the end just leaves the cursor finished */
+	if (start_cursor(&iter->cursor, &iter->graph, iter->counts, iter->root, iter->length, position))
+		set_prefix(iter, 0);
+
+	return TRUE;
+}
+
+/*
+	int next_batch(number_iter * iter, uint64_t * buf, int max)
+	fills buf with up to max of the next numbers and returns how many
+	it wrote, which is only less than max when the numbers run out.
+	returns -1 if max is not positive, so that it cannot be mistaken
+	for the end of the numbers.
+*/
+int next_batch(number_iter *iter, uint64_t *buf, int max)
+{
+	graph_cursor *cursor = &iter->cursor;
+	move_graph *graph = &iter->graph;
+	graph_node *node;
+	uint64_t base;
+	int *succ;
+	int last = iter->length - 1, count = 0, digit, i;
+
+	if (max <= 0)
+		return -1;
+
+	while ((count < max) && !cursor->finished)
+	{
+		if (last == 0)
+		{
+			buf[count++] = graph->nodes[iter->root].key - '0';
+			cursor->finished = TRUE;
+			break;
+		}
+
+		/* the last digit runs through the moves from the one before it */
+		node = graph->nodes + cursor->path[last - 1];
+		succ = graph->succ + node->first_succ;
+		base = iter->prefix[last - 1] * 10;
+
+		for (i = cursor->index[last - 1]; (i < node->succ_count) && (count < max); i++)
+			buf[count++] = base + (graph->nodes[succ[i]].key - '0');
+
+		if (i < node->succ_count)
+		{
+			/* buf is full, so carry on from here next time */
+			cursor->index[last - 1] = i;
+			cursor->path[last] = succ[i];
+			break;
+		}
+
+		cursor->index[last - 1] = node->succ_count - 1;
+		digit = advance_cursor(cursor);
+
+		if (digit > 0)
+			set_prefix(iter, digit);
+	}
+
+	iter->position += count;
+	return count;
+}
+
+/*
+	uint64_t number_iter_position(number_iter * iter)
+	returns the position of the next number the iterator will return
+*/
+uint64_t number_iter_position(number_iter *iter)
+{
+	return iter->position;
+}
+
+/*
+	uint64_t number_iter_total(number_iter * iter)
+	returns how many numbers there are altogether
+*/
+uint64_t number_iter_total(number_iter *iter)
+{
+	return iter->total;
+}
+
+/*
+	void set_prefix(number_iter * iter, int digit)
+	works out the packed prefixes from digit on, for every digit
+	but the last
+*/
+void set_prefix(number_iter *iter, int digit)
+{
+	graph_node *nodes = iter->graph.nodes;
+	uint64_t value = (digit > 0) ? iter->prefix[digit - 1] : 0;
+
+	for (; digit < iter->length - 1; digit++)
+	{
+		value = (value * 10) + (nodes[iter->cursor.path[digit]].key - '0');
+		iter->prefix[digit] = value;
+	}
+	return;
+}
@@ -0,0 +1,33 @@
+/*****************************************************************
+* Name:    number_iter.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for number_iter.c, which can be used from C
+*          or C++ without the rest of the chesspad headers
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef NUMBER_ITER_H
+#define NUMBER_ITER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct number_iter number_iter;
+
+extern number_iter *create_number_iter(const char *piece, char start_key, int length);
+extern void free_number_iter(number_iter *iter);
+extern void sort_number_iter(number_iter *iter);
+extern int seek_number_iter(number_iter *iter, uint64_t position);
+extern int next_batch(number_iter *iter, uint64_t *buf, int max);
+extern uint64_t number_iter_position(number_iter *iter);
+extern uint64_t number_iter_total(number_iter *iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
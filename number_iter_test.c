@@ -0,0 +1,167 @@
+/****************************************************************************
+* Name:    number_iter_test.c
+*
+* Creator: Frank Wallis
+* Purpose: Test driver for libchesspad.a, run by test.sh. It writes the
+*          numbers next_batch returns, in batches of the given size, as
+*          chesspad would write them, so that they can be compared with
+*          chesspad's own output. Along the way it checks that the
+*          positions add up, that seek_number_iter to the middle and
+*          the end give the same numbers as the full run, and that an
+*          empty batch is refused.
+*
+* History: 18/10/2026	FW	Created.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "stdtypes.h"
+#include "chesspad.h"
+#include "number_iter.h"
+
+/* prototypes */
+
+int read_numbers(number_iter *iter, uint64_t *numbers, uint64_t total, int batch_size);
+int check_seek(number_iter *iter, uint64_t *numbers, uint64_t total, uint64_t position, int batch_size);
+int fail(char *reason);
+void display_usage(char *program_name);
+
+int main(int argc, char *argv[])
+{
+	number_iter *iter;
+	uint64_t *numbers, total, i;
+	int length, batch_size, ok;
+
+	if ((argc < 5) || ((argc > 5) && (strcmp(argv[5], "sorted") != 0)))
+	{
+		display_usage(argv[0]);
+		return 1;
+	}
+
+	length = atoi(argv[3]);
+	batch_size = atoi(argv[4]);
+	if (batch_size < 1)
+	{
+		printf("Batch size must be at least 1\n");
+		return 1;
+	}
+
+	if ((iter = create_number_iter(argv[1], argv[2][0], length)) == NULL)
+	{
+		printf("Invalid piece, key or length\n");
+		return 1;
+	}
+
+	if (argc > 5)
+		sort_number_iter(iter);
+
+	total = number_iter_total(iter);
+	/* with room for a batch past the end, in case one comes back */
+	numbers = malloc((total + batch_size) * sizeof(uint64_t));
+	if (numbers == NULL)
+	{
+		printf("Out of memory\n");
+		free_number_iter(iter);
+		return 1;
+	}
+
+	ok = read_numbers(iter, numbers, total, batch_size) &&
+		 check_seek(iter, numbers, total, total / 2, batch_size) &&
+		 check_seek(iter, numbers, total, total, batch_size);
+
+	if (ok && seek_number_iter(iter, total + 1))
+		ok = fail("seek_number_iter went past the end");
+
+	/* the numbers are packed, so put back any leading zeroes */
+	for (i = 0; ok && (i < total); i++)
+		printf("%0*llu\n", length, (unsigned long long)numbers[i]);
+
+	free(numbers);
+	free_number_iter(iter);
+	return ok ? 0 : 1;
+}
+
+/*
+	int read_numbers(number_iter * iter, uint64_t * numbers, uint64_t total, int batch_size)
+	reads all total numbers from iter into numbers, batch_size at a
+	time, checking the position after each batch and that an empty
+	batch is refused. returns FALSE if anything is wrong.
+*/
+int read_numbers(number_iter *iter, uint64_t *numbers, uint64_t total, int batch_size)
+{
+	uint64_t count = 0;
+	int n;
+
+	if ((next_batch(iter, numbers, 0) != -1) || (next_batch(iter, numbers, -1) != -1))
+		return fail("next_batch did not refuse an empty batch");
+
+	while (count < total)
+	{
+		/* only the last batch may come up short */
+		n = next_batch(iter, numbers + count, batch_size);
+		if ((n < 1) || ((n < batch_size) && (count + n != total)) || (count + n > total))
+			return fail("next_batch returned the wrong number of numbers");
+
+		count += n;
+		if (number_iter_position(iter) != count)
+			return fail("number_iter_position is wrong");
+	}
+
+	if (next_batch(iter, numbers + total, batch_size) != 0)
+		return fail("next_batch carried on past the end");
+
+	return TRUE;
+}
+
+/*
+	int check_seek(number_iter * iter, uint64_t * numbers, uint64_t total, uint64_t position, int batch_size)
+	seeks iter to position and checks that it returns the rest of the
+	numbers as read first time round. returns FALSE if it does not.
+*/
+int check_seek(number_iter *iter, uint64_t *numbers, uint64_t total, uint64_t position, int batch_size)
+{
+	uint64_t *batch;
+	int n;
+
+	if (!seek_number_iter(iter, position) || (number_iter_position(iter) != position))
+		return fail("seek_number_iter did not move to the position");
+
+	if ((batch = malloc(batch_size * sizeof(uint64_t))) == NULL)
+		return fail("Out of memory");
+
+	while ((n = next_batch(iter, batch, batch_size)) > 0)
+	{
+		if ((position + n > total) || (memcmp(batch, numbers + position, n * sizeof(uint64_t)) != 0))
+			break;
+
+		position += n;
+	}
+
+	free(batch);
+
+	if ((n != 0) || (position != total))
+		return fail("seek_number_iter gave different numbers");
+
+	return TRUE;
+}
+
+/*
+	int fail(char * reason)
+	reports why the test failed. returns FALSE.
+*/
+int fail(char *reason)
+{
+	fprintf(stderr, "%s\n", reason);
+	return FALSE;
+}
+
+/*
+	void display_usage(char * program_name)
+	show accepted command line args
+*/
+void display_usage(char *program_name)
+{
+	printf("Usage %s <chess_piece> <start_key> <length> <batch_size> [ sorted ]\n", program_name);
+}
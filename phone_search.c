@@ -0,0 +1,175 @@
+/*****************************************************************
+* Name:    phone_search.c
+*
+* Creator: Frank Wallis
+* Purpose: The chesspad search, which follows every route through the
+*          move graph and writes out the phone numbers. It is kept
+*          apart from chesspad.c so that bench times the same code.
+*
+* History: 18/10/2026	FW	Created from chesspad.c.
+******************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "stdtypes.h"
+#include "keypad.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "move_graph.h"
+#include "checkpoint.h"
+#include "phone_search.h"
+
+/* prototypes */
+void resume_moves(int current_node, int current_digit, uint64_t skip);
+void output_moves(int current_node, int current_digit);
+void save_position(int current_digit, int complete);
+
+void next_move(int current_node, int current_digit);
+void write_phoneno(void);
+
+/* globals */
+
+int g_phoneno_length = PHONENO_LENGTH_DEF;
+char g_output[PHONENO_LENGTH_MAX + 1] = {};
+uint64_t g_output_counter = 0;
+int g_output_summary = 0;
+move_graph g_graph;
+uint64_t *g_counts;
+
+char *g_checkpoint_file = NULL;
+char *g_piece_arg;
+char g_start_key;
+int g_sorted = FALSE;
+
+/*
+	void resume_moves(int current_node, int current_digit, uint64_t skip)
+	outputs the phone numbers from current_node, skipping the first skip
+	of them by using the count table to pass over whole subtrees
+*/
+void resume_moves(int current_node, int current_digit, uint64_t skip)
+{
+	int i;
+	uint64_t count;
+	graph_node *node = g_graph.nodes + current_node;
+	int *succ = g_graph.succ + node->first_succ;
+
+	if (skip == 0)
+	{
+		output_moves(current_node, current_digit);
+		return;
+	}
+
+	g_output[current_digit] = node->key;
+	current_digit++;
+
+	for (i = 0; i < node->succ_count; i++)
+	{
+		if (skip == 0)
+			output_moves(succ[i], current_digit);
+		else
+		{
+			count = graph_count(&g_graph, g_counts, succ[i], g_phoneno_length - current_digit);
+
+			if (skip >= count)
+				skip -= count;
+			else
+			{
+				resume_moves(succ[i], current_digit, skip);
+				skip = 0;
+			}
+		}
+	}
+
+	return;
+}
+
+/*
+	void output_moves(int current_node, int current_digit)
+	follows all the available routes that the piece can take from current_node,
+	and outputs the resulting phone numbers
+*/
+void output_moves(int current_node, int current_digit)
+{
+	/* set this key in the output string and move on to the next digit */
+	g_output[current_digit] = g_graph.nodes[current_node].key;
+
+	/* if we have reached the required length then output the string 
+	   otherwise continue moving around the keypad */
+	if (current_digit == g_phoneno_length - 1)
+		write_phoneno();
+	else
+		next_move(current_node, current_digit);
+
+	return;
+}
+
+/*
+	void next_move(int current_node, int current_digit)
+	outputs all the remaining combinations for the current starting digits.
+	The successors of each node already include staying in the same place,
+	and any change of piece (eg. a pawn reaching the top row)
+*/
+void next_move(int current_node, int current_digit)
+{
+	int i;
+	graph_node *node = g_graph.nodes + current_node;
+	int *succ = g_graph.succ + node->first_succ;
+
+	/* we are between numbers here, so save our position if it is time to */
+	if (g_checkpoint_due)
+		save_position(current_digit, FALSE);
+
+	current_digit++;
+
+	/* follow each of the nodes available from here */
+	for (i = 0; i < node->succ_count; i++)
+		output_moves(succ[i], current_digit);
+
+	return;
+}
+
+/*
+	void save_position(int current_digit, int complete)
+	writes a checkpoint: the numbers written so far, and the digits up to
+	current_digit which start the next one
+*/
+void save_position(int current_digit, int complete)
+{
+	checkpoint_rec rec;
+
+	memset(&rec, 0, sizeof(rec));
+	strcpy(rec.piece, g_piece_arg);
+	rec.key = g_start_key;
+	rec.length = g_phoneno_length;
+	rec.rank = g_output_counter;
+	rec.complete = complete;
+	rec.sorted = g_sorted;
+	memcpy(rec.prefix, g_output, current_digit + 1);
+
+	/* everything up to here must be on disk before the checkpoint is */
+	if ((fflush(stdout) == 0) && (fsync(fileno(stdout)) == 0))
+		rec.offset = ftello(stdout);
+
+	if ((rec.offset != rec.rank * (g_phoneno_length + 1)) || !write_checkpoint(g_checkpoint_file, &rec))
+		fprintf(stderr, "Failed to write checkpoint %s\n", g_checkpoint_file);
+
+	if (!complete)
+		restart_checkpoint_timer();
+	return;
+}
+
+/*
+	void write_phoneno()
+	outputs the current phone number to stdout. The progress thread
+	reads the count, so it is stored atomically.
+*/
+void write_phoneno(void)
+{
+	if (!g_output_summary)
+		printf("%s\n", g_output);
+
+	__atomic_store_n(&g_output_counter, g_output_counter + 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,30 @@
+/*****************************************************************
+* Name:    phone_search.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for phone_search.c
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef PHONE_SEARCH_H
+#define PHONE_SEARCH_H
+
+/* the search and the numbers it has written */
+extern int g_phoneno_length;
+extern char g_output[PHONENO_LENGTH_MAX + 1];
+extern uint64_t g_output_counter;
+extern int g_output_summary;
+extern move_graph g_graph;
+extern uint64_t *g_counts;
+
+/* what a checkpoint records about the search */
+extern char *g_checkpoint_file;
+extern char *g_piece_arg;
+extern char g_start_key;
+extern int g_sorted;
+
+extern void resume_moves(int current_node, int current_digit, uint64_t skip);
+extern void output_moves(int current_node, int current_digit);
+extern void save_position(int current_digit, int complete);
+
+#endif
@@ -0,0 +1,526 @@
+/*****************************************************************
+* Name:    piece_defs.c
+*
+* Creator: Frank Wallis
+* Purpose: Parses declarative piece definitions. A piece is a list of
+*          states separated by ';', the first of which is the piece
+*          itself:
+*
+*            <state> : <moves> [ > [ <condition> ] <state>[|<state>] ]
+*
+*          moves are vectors 'dx,dy[,hops]' or the shorthands
+*          'perp:hops', 'diag:hops' and 'leap:a,b[,hops]', where hops
+*          of '*' means until the edge of the board. Each time the
+*          piece moves on, the first rule whose condition ('x' or 'y'
+*          compared with '<', '=' or '>') matches the current square
+*          gives the state(s) it moves in. If no rule matches the
+*          piece keeps its state; more than one target state lets the
+*          piece choose, eg. for under-promotion.
+*
+*          A relay is a list of pieces separated by '/' which take it
+*          in turns to dial the digits, starting with the first key,
+*          and is made into one piece with a set of states for each
+*          place in the list.
+*
+* History: 18/10/2026	FW	Created.
+*          18/10/2026	FW	Added relays.
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "stdtypes.h"
+#include "chess_moves.h"
+#include "piece_defs.h"
+
+/* prototypes */
+int get_piece_def(char *str, piece_def *def);
+int parse_piece_def(char *text, piece_def *def);
+int get_relay_def(char *str, piece_def *def);
+int relay_piece_def(piece_def *pieces, int count, piece_def *def);
+unsigned int next_piece_states(piece_def *def, int state, coor *square);
+
+int parse_state_body(piece_def *def, piece_state *state, char *body);
+int parse_move(piece_state *state, char *token);
+int parse_rule_token(piece_def *def, state_rule *rule, char *token);
+int parse_hops(char *str, int *hops);
+int add_vector(piece_state *state, int dx, int dy, int max_hops);
+int find_state(piece_def *def, char *name);
+char *next_token(char **cursor);
+char *trim(char *str);
+
+/* definitions of the standard pieces, in the same vector order as
+   the add_xxx_moves functions in chess_moves.c */
+typedef struct
+{
+	char *name;
+	char *definition;
+} builtin_piece;
+
+static builtin_piece g_builtin_pieces[] = {
+	{"king", "king: perp:1 diag:1"},
+	{"queen", "queen: perp:* diag:*"},
+	{"bishop", "bishop: diag:*"},
+	{"knight", "knight: leap:2,1"},
+	{"horse", "knight: leap:2,1"},
+	{"rook", "rook: perp:*"},
+	{"castle", "rook: perp:*"},
+	{"pawn", "pawn: > y<2 special > y=3 queen > step;"
+			 "special: 0,1,2 > step;"
+			 "step: 0,1,1 > y=3 queen;"
+			 "queen: perp:* diag:*"},
+	{"underpawn", "underpawn: > y<2 special > y=3 queen|rook|bishop|knight > step;"
+				  "special: 0,1,2 > step;"
+				  "step: 0,1,1 > y=3 queen|rook|bishop|knight;"
+				  "queen: perp:* diag:*;"
+				  "rook: perp:*;"
+				  "bishop: diag:*;"
+				  "knight: leap:2,1"},
+};
+
+#define NUM_BUILTIN_PIECES (sizeof(g_builtin_pieces) / sizeof(g_builtin_pieces[0]))
+
+/*
+	int get_piece_def(char * str, piece_def * def)
+	fills def for either the name of a standard piece, a piece
+	definition (anything containing a ':') or a relay (anything
+	containing a '/'). Returns FALSE if the piece is not recognised or
+	the definition is invalid.
+*/
+int get_piece_def(char *str, piece_def *def)
+{
+	int i;
+
+	if (strchr(str, '/') != NULL)
+		return get_relay_def(str, def);
+
+	if (strchr(str, ':') != NULL)
+		return parse_piece_def(str, def);
+
+	/* convert to lowercase */
+	for (i = 0; str[i] != '\0'; i++)
+		str[i] = tolower((unsigned char)str[i]);
+
+	/* and find the piece */
+	for (i = 0; i < NUM_BUILTIN_PIECES; i++)
+		if (strcmp(str, g_builtin_pieces[i].name) == 0)
+			return parse_piece_def(g_builtin_pieces[i].definition, def);
+
+	return FALSE;
+}
+
+/*
+	int parse_piece_def(char * text, piece_def * def)
+	parses a piece definition into def.
+	returns FALSE if the definition is invalid.
+*/
+int parse_piece_def(char *text, piece_def *def)
+{
+	char buffer[PIECE_DEF_MAX];
+	char *bodies[MAX_PIECE_STATES];
+	char *clause, *colon, *end;
+	int i;
+
+	if (strlen(text) >= PIECE_DEF_MAX)
+		return FALSE;
+
+	memset(def, 0, sizeof(piece_def));
+	strcpy(buffer, text);
+
+	for (i = 0; buffer[i] != '\0'; i++)
+		buffer[i] = tolower((unsigned char)buffer[i]);
+
+	/* first pass splits the states up and names them, so that rules
+	   can refer to states defined after them */
+	for (clause = buffer; clause != NULL; clause = end)
+	{
+		end = strchr(clause, ';');
+		if (end != NULL)
+			*end++ = '\0';
+
+		/* allow a trailing ';' */
+		if ((*trim(clause) == '\0') && (end == NULL) && (def->state_count > 0))
+			break;
+
+		colon = strchr(clause, ':');
+		if ((colon == NULL) || (def->state_count == MAX_PIECE_STATES))
+			return FALSE;
+
+		*colon = '\0';
+		clause = trim(clause);
+
+		if ((*clause == '\0') || (strlen(clause) >= PIECE_NAME_MAX))
+			return FALSE;
+
+		for (i = 0; clause[i] != '\0'; i++)
+			if (!isalnum(clause[i]) && (clause[i] != '_'))
+				return FALSE;
+
+		if (find_state(def, clause) != -1)
+			return FALSE;
+
+		strcpy(def->states[def->state_count].name, clause);
+		bodies[def->state_count] = colon + 1;
+		def->state_count++;
+	}
+
+	/* then fill in the moves and rules for each one */
+	for (i = 0; i < def->state_count; i++)
+		if (!parse_state_body(def, def->states + i, bodies[i]))
+			return FALSE;
+
+	strcpy(def->name, def->states[0].name);
+	return TRUE;
+}
+
+/*
+	int get_relay_def(char * str, piece_def * def)
+	fills def for a relay of pieces separated by '/'.
+	returns FALSE if any of them is invalid or there are too many states.
+*/
+int get_relay_def(char *str, piece_def *def)
+{
+	char buffer[PIECE_DEF_MAX];
+	piece_def *pieces;
+	char *part, *end;
+	int count = 0, valid = TRUE;
+
+	if (strlen(str) >= PIECE_DEF_MAX)
+		return FALSE;
+
+	/* a piece_def is too big to keep a list of them on the stack */
+	pieces = malloc(MAX_PIECE_STATES * sizeof(piece_def));
+	if (pieces == NULL)
+		return FALSE;
+
+	strcpy(buffer, str);
+
+	for (part = buffer; valid && (part != NULL); part = end)
+	{
+		end = strchr(part, '/');
+		if (end != NULL)
+			*end++ = '\0';
+
+		valid = (count < MAX_PIECE_STATES) && get_piece_def(trim(part), pieces + count);
+		count++;
+	}
+
+	valid = valid && relay_piece_def(pieces, count, def);
+	free(pieces);
+	return valid;
+}
+
+/*
+	int relay_piece_def(piece_def * pieces, int count, piece_def * def)
+	makes the pieces into one piece, whose states are each piece's
+	states in turn. Every state keeps its moves, but its rules are
+	replaced by those of the next piece's first state, so that after
+	one piece has moved the next one starts its turn from wherever it
+	landed. returns FALSE if there are too many states or rules.
+*/
+int relay_piece_def(piece_def *pieces, int count, piece_def *def)
+{
+	int base[MAX_PIECE_STATES + 1];
+	piece_state *state, *first;
+	state_rule *rule;
+	int piece, next, s, i;
+
+	/* the states of each piece follow on from the last */
+	base[0] = 0;
+	for (piece = 0; piece < count; piece++)
+	{
+		base[piece + 1] = base[piece] + pieces[piece].state_count;
+		if (base[piece + 1] > MAX_PIECE_STATES)
+			return FALSE;
+	}
+
+	memset(def, 0, sizeof(piece_def));
+	strcpy(def->name, "relay");
+	def->state_count = base[count];
+
+	for (piece = 0; piece < count; piece++)
+	{
+		next = (piece + 1) % count;
+		first = pieces[next].states;
+
+		for (s = 0; s < pieces[piece].state_count; s++)
+		{
+			state = def->states + base[piece] + s;
+			*state = pieces[piece].states[s];
+			state->rule_count = first->rule_count;
+
+			for (i = 0; i < first->rule_count; i++)
+			{
+				state->rules[i] = first->rules[i];
+				state->rules[i].targets <<= base[next];
+			}
+
+			/* if none of them match the next piece moves in its first state */
+			rule = state->rules + state->rule_count - 1;
+			if ((state->rule_count > 0) && (rule->axis == 0))
+				continue;
+
+			if (state->rule_count == MAX_STATE_RULES)
+				return FALSE;
+
+			rule = state->rules + state->rule_count++;
+			rule->axis = 0;
+			rule->targets = 1u << base[next];
+		}
+	}
+	return TRUE;
+}
+
+/*
+	int parse_state_body(piece_def * def, piece_state * state, char * body)
+	parses the moves and transition rules of a single state
+*/
+int parse_state_body(piece_def *def, piece_state *state, char *body)
+{
+	char *token;
+	state_rule *rule = NULL;
+
+	while ((token = next_token(&body)) != NULL)
+	{
+		/* '>' starts a new rule, and may be joined to its first token */
+		if (token[0] == '>')
+		{
+			if (state->rule_count == MAX_STATE_RULES)
+				return FALSE;
+
+			if ((rule != NULL) && (rule->targets == 0))
+				return FALSE;
+
+			rule = state->rules + state->rule_count++;
+			token++;
+
+			if (*token == '\0')
+				continue;
+		}
+
+		if (rule == NULL)
+		{
+			if (!parse_move(state, token))
+				return FALSE;
+		}
+		else if (!parse_rule_token(def, rule, token))
+			return FALSE;
+	}
+
+	/* every rule needs somewhere to go */
+	return ((rule == NULL) || (rule->targets != 0));
+}
+
+/*
+	int parse_move(piece_state * state, char * token)
+	adds the vectors for a single move token to the state
+*/
+int parse_move(piece_state *state, char *token)
+{
+	int a, b, hops, used;
+	char *arg = strchr(token, ':');
+
+	if (arg != NULL)
+	{
+		*arg++ = '\0';
+
+		if (strcmp(token, "perp") == 0)
+		{
+			if (!parse_hops(arg, &hops))
+				return FALSE;
+
+			return add_vector(state, 1, 0, hops) && add_vector(state, 0, 1, hops) &&
+				   add_vector(state, -1, 0, hops) && add_vector(state, 0, -1, hops);
+		}
+		else if (strcmp(token, "diag") == 0)
+		{
+			if (!parse_hops(arg, &hops))
+				return FALSE;
+
+			return add_vector(state, 1, 1, hops) && add_vector(state, -1, 1, hops) &&
+				   add_vector(state, 1, -1, hops) && add_vector(state, -1, -1, hops);
+		}
+		else if (strcmp(token, "leap") == 0)
+		{
+			hops = 1;
+			if (sscanf(arg, "%d,%d%n", &a, &b, &used) != 2)
+				return FALSE;
+
+			if ((arg[used] == ',') && !parse_hops(arg + used + 1, &hops))
+				return FALSE;
+			else if ((arg[used] != ',') && (arg[used] != '\0'))
+				return FALSE;
+
+			return add_vector(state, a, b, hops) && add_vector(state, a, -b, hops) &&
+				   add_vector(state, -a, b, hops) && add_vector(state, -a, -b, hops) &&
+				   add_vector(state, b, a, hops) && add_vector(state, b, -a, hops) &&
+				   add_vector(state, -b, a, hops) && add_vector(state, -b, -a, hops);
+		}
+		return FALSE;
+	}
+
+	/* a plain vector */
+	hops = 1;
+	if (sscanf(token, "%d,%d%n", &a, &b, &used) != 2)
+		return FALSE;
+
+	if ((token[used] == ',') && !parse_hops(token + used + 1, &hops))
+		return FALSE;
+	else if ((token[used] != ',') && (token[used] != '\0'))
+		return FALSE;
+
+	return add_vector(state, a, b, hops);
+}
+
+/*
+	int parse_rule_token(piece_def * def, state_rule * rule, char * token)
+	a rule token is either a condition on the square, which must come
+	first, or a list of target states separated by '|'
+*/
+int parse_rule_token(piece_def *def, state_rule *rule, char *token)
+{
+	char *name, *end;
+	int state, used;
+
+	if (((token[0] == 'x') || (token[0] == 'y')) && (token[1] != '\0') &&
+		(strchr("<=>", token[1]) != NULL))
+	{
+		if ((rule->axis != 0) || (rule->targets != 0))
+			return FALSE;
+
+		if ((sscanf(token + 2, "%d%n", &rule->value, &used) != 1) || (token[used + 2] != '\0'))
+			return FALSE;
+
+		rule->axis = token[0];
+		rule->op = token[1];
+		return TRUE;
+	}
+
+	for (name = token; name != NULL; name = end)
+	{
+		end = strchr(name, '|');
+		if (end != NULL)
+			*end++ = '\0';
+
+		state = find_state(def, name);
+		if (state == -1)
+			return FALSE;
+
+		rule->targets |= (1u << state);
+	}
+	return TRUE;
+}
+
+/*
+	int parse_hops(char * str, int * hops)
+	'*' means no limit, otherwise it must be a positive number
+*/
+int parse_hops(char *str, int *hops)
+{
+	int used;
+
+	if (strcmp(str, "*") == 0)
+	{
+		*hops = INFINITE;
+		return TRUE;
+	}
+
+	if ((sscanf(str, "%d%n", hops, &used) != 1) || (str[used] != '\0'))
+		return FALSE;
+
+	return (*hops > 0);
+}
+
+/*
+	int add_vector(piece_state * state, int dx, int dy, int max_hops)
+	appends a move vector to the state
+*/
+int add_vector(piece_state *state, int dx, int dy, int max_hops)
+{
+	if ((state->vector_count == MAX_STATE_VECTORS) || ((dx == 0) && (dy == 0)))
+		return FALSE;
+
+	state->vectors[state->vector_count].dx = dx;
+	state->vectors[state->vector_count].dy = dy;
+	state->vectors[state->vector_count].max_hops = max_hops;
+	state->vector_count++;
+	return TRUE;
+}
+
+/*
+	unsigned int next_piece_states(piece_def * def, int state, coor * square)
+	returns the set of states (as a bit mask) which a piece in this state
+	can move on in from square
+*/
+unsigned int next_piece_states(piece_def *def, int state, coor *square)
+{
+	int i, value;
+	state_rule *rule;
+
+	for (i = 0; i < def->states[state].rule_count; i++)
+	{
+		rule = def->states[state].rules + i;
+
+		if (rule->axis == 0)
+			return rule->targets;
+
+		value = (rule->axis == 'x') ? square->x : square->y;
+
+		if (((rule->op == '<') && (value < rule->value)) ||
+			((rule->op == '=') && (value == rule->value)) ||
+			((rule->op == '>') && (value > rule->value)))
+			return rule->targets;
+	}
+	return (1u << state);
+}
+
+/*
+	int find_state(piece_def * def, char * name)
+	returns the index of the named state, or -1
+*/
+int find_state(piece_def *def, char *name)
+{
+	int i;
+
+	for (i = 0; i < def->state_count; i++)
+		if (strcmp(def->states[i].name, name) == 0)
+			return i;
+
+	return -1;
+}
+
+/*
+	char * next_token(char ** cursor)
+	returns the next whitespace separated token, or NULL at the end
+*/
+char *next_token(char **cursor)
+{
+	char *token = *cursor + strspn(*cursor, " \t\r\n");
+
+	if (*token == '\0')
+		return NULL;
+
+	*cursor = token + strcspn(token, " \t\r\n");
+	if (**cursor != '\0')
+		*(*cursor)++ = '\0';
+
+	return token;
+}
+
+/*
+	char * trim(char * str)
+	strips leading and trailing whitespace
+*/
+char *trim(char *str)
+{
+	char *end;
+
+	str += strspn(str, " \t\r\n");
+	end = str + strlen(str);
+
+	while ((end > str) && isspace((unsigned char)end[-1]))
+		*--end = '\0';
+
+	return str;
+}
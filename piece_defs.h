@@ -0,0 +1,56 @@
+/*****************************************************************
+* Name:    piece_defs.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for piece_defs.c
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef PIECE_DEFS_H
+#define PIECE_DEFS_H
+
+#define PIECE_NAME_MAX 32
+#define PIECE_DEF_MAX 1024
+#define MAX_PIECE_STATES 32
+#define MAX_STATE_VECTORS 32
+#define MAX_STATE_RULES 8
+
+typedef struct
+{
+	int dx;
+	int dy;
+	int max_hops;
+} move_vector;
+
+/* a transition taken when the piece moves on from a square matching
+   the condition. axis is 'x' or 'y', or 0 for an unconditional rule */
+typedef struct
+{
+	char axis;
+	char op;
+	int value;
+	unsigned int targets;
+} state_rule;
+
+typedef struct
+{
+	char name[PIECE_NAME_MAX];
+	move_vector vectors[MAX_STATE_VECTORS];
+	int vector_count;
+	state_rule rules[MAX_STATE_RULES];
+	int rule_count;
+} piece_state;
+
+/* a piece is a small state machine, and starts in states[0] */
+typedef struct
+{
+	char name[PIECE_NAME_MAX];
+	piece_state states[MAX_PIECE_STATES];
+	int state_count;
+} piece_def;
+
+extern int get_piece_def(char *str, piece_def *def);
+extern int parse_piece_def(char *text, piece_def *def);
+extern unsigned int next_piece_states(piece_def *def, int state, coor *square);
+
+#endif
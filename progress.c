@@ -0,0 +1,179 @@
+/*****************************************************************
+* Name:    progress.c
+*
+* Creator: Frank Wallis
+* Purpose: Reports the progress of a long search from a background
+*          thread, so that the search itself does no extra work. The
+*          thread reads the count of numbers written so far, which is
+*          the rank of the number the search has reached, and compares
+*          it with the total worked out from the move graph up front.
+*          The count must be updated with __atomic_store_n; relaxed
+*          ordering is enough, as it is only ever read for reporting.
+*
+* History: 18/10/2026	FW	Created.
+*          18/10/2026	FW	Replace the status file atomically, and read the count atomically.
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "stdtypes.h"
+#include "progress.h"
+
+/* prototypes */
+int start_progress(uint64_t *emitted, uint64_t total, int interval, char *status_file);
+void stop_progress(void);
+
+void *progress_thread(void *arg);
+void report_progress(int final);
+void format_duration(char *str, double seconds);
+
+/* globals */
+
+static pthread_t g_thread;
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_stop = PTHREAD_COND_INITIALIZER;
+static int g_running = FALSE;
+
+static uint64_t *g_emitted;
+static uint64_t g_total;
+static uint64_t g_first;
+static int g_interval;
+static char *g_status_file;
+static struct timespec g_start;
+
+/*
+	int start_progress(uint64_t * emitted, uint64_t total, int interval, char * status_file)
+	starts reporting every interval seconds how far emitted has got
+	towards total, to stderr or, if status_file is given, by rewriting
+	that file. returns FALSE if the thread cannot be started.
+*/
+int start_progress(uint64_t *emitted, uint64_t total, int interval, char *status_file)
+{
+	g_emitted = emitted;
+	g_first = __atomic_load_n(emitted, __ATOMIC_RELAXED);
+	g_total = total;
+	g_interval = interval;
+	g_status_file = status_file;
+	clock_gettime(CLOCK_MONOTONIC, &g_start);
+
+	g_running = TRUE;
+	if (pthread_create(&g_thread, NULL, progress_thread, NULL) != 0)
+	{
+		g_running = FALSE;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+	void stop_progress(void)
+	stops the reporting thread and writes the final figures
+*/
+void stop_progress(void)
+{
+	if (!g_running)
+		return;
+
+	pthread_mutex_lock(&g_mutex);
+	g_running = FALSE;
+	pthread_cond_signal(&g_stop);
+	pthread_mutex_unlock(&g_mutex);
+
+	pthread_join(g_thread, NULL);
+	report_progress(TRUE);
+	return;
+}
+
+/*
+	void * progress_thread(void * arg)
+	wakes up every interval to report, until stop_progress is called
+*/
+void *progress_thread(void *arg)
+{
+	struct timespec wake;
+
+	clock_gettime(CLOCK_REALTIME, &wake);
+
+	pthread_mutex_lock(&g_mutex);
+	while (g_running)
+	{
+		wake.tv_sec += g_interval;
+		pthread_cond_timedwait(&g_stop, &g_mutex, &wake);
+
+		if (g_running)
+			report_progress(FALSE);
+	}
+	pthread_mutex_unlock(&g_mutex);
+
+	return NULL;
+}
+
+/*
+	void report_progress(int final)
+	writes the numbers emitted, percentage complete, throughput and ETA
+*/
+void report_progress(int final)
+{
+	struct timespec now;
+	char elapsed_str[32], eta_str[32], temp_file[FILENAME_MAX];
+	double elapsed, rate, percent;
+	uint64_t emitted = __atomic_load_n(g_emitted, __ATOMIC_RELAXED);
+	FILE *status;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = (now.tv_sec - g_start.tv_sec) + ((now.tv_nsec - g_start.tv_nsec) / 1e9);
+
+	/* a resumed search may have started part way through */
+	rate = (elapsed > 0) ? (emitted - g_first) / elapsed : 0;
+	percent = (g_total > 0) ? (100.0 * emitted) / g_total : 100.0;
+
+	format_duration(elapsed_str, elapsed);
+	if (rate > 0)
+		format_duration(eta_str, (g_total - emitted) / rate);
+	else
+		strcpy(eta_str, "unknown");
+
+	if (g_status_file == NULL)
+	{
+		fprintf(stderr, "\r%6.2f%%  %llu of %llu numbers  %.0f/s  elapsed %s  ETA %s ",
+				percent, (unsigned long long)emitted, (unsigned long long)g_total, rate,
+				elapsed_str, eta_str);
+
+		if (final)
+			fprintf(stderr, "\n");
+		return;
+	}
+
+	/* the status file just holds the latest report. It is written to a
+	   temporary file and renamed, so anyone reading it sees a whole one */
+	if (snprintf(temp_file, sizeof(temp_file), "%s.tmp", g_status_file) >= sizeof(temp_file))
+		return;
+
+	status = fopen(temp_file, "w");
+	if (status == NULL)
+		return;
+
+	fprintf(status, "emitted %llu\ntotal %llu\npercent %.2f\nrate %.0f\nelapsed %s\neta %s\nstate %s\n",
+			(unsigned long long)emitted, (unsigned long long)g_total, percent, rate,
+			elapsed_str, eta_str, final ? "finished" : "running");
+
+	if ((fclose(status) != 0) || (rename(temp_file, g_status_file) != 0))
+		remove(temp_file);
+	return;
+}
+
+/*
+	void format_duration(char * str, double seconds)
+	formats seconds as h:mm:ss
+*/
+void format_duration(char *str, double seconds)
+{
+	long total = (long)(seconds + 0.5);
+
+	sprintf(str, "%ld:%02ld:%02ld", total / 3600, (total / 60) % 60, total % 60);
+	return;
+}
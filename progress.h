@@ -0,0 +1,17 @@
+/*****************************************************************
+* Name:    progress.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for progress.c
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#define PROGRESS_INTERVAL_DEF 1
+
+extern int start_progress(uint64_t *emitted, uint64_t total, int interval, char *status_file);
+extern void stop_progress(void);
+
+#endif
@@ -0,0 +1,331 @@
+/*****************************************************************
+* Name:    result_store.c
+*
+* Creator: Frank Wallis
+* Purpose: Saves the phone numbers for a piece, start key and length
+*          to a binary file which can be mapped straight into memory
+*          and searched without being read or parsed. The numbers are
+*          kept in numerical order with an index of where each prefix
+*          starts, so finding the numbers with a given prefix is two
+*          lookups.
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "stdtypes.h"
+#include "chesspad.h"
+#include "number_iter.h"
+#include "result_store.h"
+
+#define STORE_BATCH 65536
+
+/* prototypes */
+int write_result_store(const char *file, const char *piece, char start_key, int length, uint64_t *written);
+int open_result_store(const char *file, result_store *store);
+void close_result_store(result_store *store);
+int store_prefix_range(result_store *store, const char *prefix, uint64_t *first, uint64_t *count);
+
+int write_numbers(FILE *out, number_iter *iter, store_header *header, uint64_t *index, uint64_t *written);
+uint64_t lower_bound(uint64_t *numbers, uint64_t low, uint64_t high, uint64_t value);
+int valid_header(result_store *store);
+uint64_t power_of_ten(int digits);
+
+/*
+	int write_result_store(const char * file, const char * piece, char start_key, int length, uint64_t * written)
+	saves the numbers of length digits the piece can dial from
+	start_key to file, setting written (if not NULL) to how many have
+	been saved as it goes. It is written to a temporary file and
+	renamed, so that file is always complete. returns FALSE if the
+	piece, key or length are not valid or the file cannot be written.
+*/
+int write_result_store(const char *file, const char *piece, char start_key, int length, uint64_t *written)
+{
+	char temp_file[FILENAME_MAX];
+	store_header header;
+	number_iter *iter;
+	uint64_t *index;
+	FILE *out;
+	int ok;
+
+	if ((strlen(piece) >= STORE_PIECE_MAX) ||
+		(snprintf(temp_file, sizeof(temp_file), "%s.tmp", file) >= sizeof(temp_file)))
+		return FALSE;
+
+	iter = create_number_iter(piece, start_key, length);
+	if (iter == NULL)
+		return FALSE;
+
+	/* the index only works if the numbers are in order */
+	sort_number_iter(iter);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+	header.version = STORE_VERSION;
+	header.length = length;
+	header.prefix_digits = (length < STORE_PREFIX_MAX) ? length : STORE_PREFIX_MAX;
+	header.key = start_key;
+	header.count = number_iter_total(iter);
+	header.index_offset = sizeof(store_header);
+	header.numbers_offset = header.index_offset + ((power_of_ten(header.prefix_digits) + 1) * sizeof(uint64_t));
+	strcpy(header.piece, piece);
+
+	index = calloc(power_of_ten(header.prefix_digits) + 1, sizeof(uint64_t));
+	out = fopen(temp_file, "wb");
+
+	ok = (index != NULL) && (out != NULL) && write_numbers(out, iter, &header, index, written);
+
+	if (out != NULL)
+	{
+		ok = ok && (fflush(out) == 0) && (fsync(fileno(out)) == 0);
+		ok = (fclose(out) == 0) && ok;
+	}
+
+	if (!ok || (rename(temp_file, file) != 0))
+	{
+		remove(temp_file);
+		ok = FALSE;
+	}
+
+	free(index);
+	free_number_iter(iter);
+	return ok;
+}
+
+/*
+	int write_numbers(FILE * out, number_iter * iter, store_header * header, uint64_t * index, uint64_t * written)
+	writes the header, numbers and index. index must be zeroed, and is
+	only known once all the numbers have gone, so it goes in last.
+	returns FALSE if the writes fail.
+*/
+int write_numbers(FILE *out, number_iter *iter, store_header *header, uint64_t *index, uint64_t *written)
+{
+	uint64_t *batch;
+	uint64_t entries = power_of_ten(header->prefix_digits) + 1;
+	uint64_t divisor = power_of_ten(header->length - header->prefix_digits);
+	uint64_t i;
+	int count, j, ok = TRUE;
+
+	/* leave room for the index */
+	if ((fwrite(header, sizeof(store_header), 1, out) != 1) ||
+		(fseeko(out, header->numbers_offset, SEEK_SET) != 0))
+		return FALSE;
+
+	batch = malloc(STORE_BATCH * sizeof(uint64_t));
+	if (batch == NULL)
+		return FALSE;
+
+	while (ok && ((count = next_batch(iter, batch, STORE_BATCH)) > 0))
+	{
+		/* count each prefix one place on, so the running totals are the starts */
+		for (j = 0; j < count; j++)
+			index[(batch[j] / divisor) + 1]++;
+
+		ok = (fwrite(batch, sizeof(uint64_t), count, out) == count);
+
+		/* which may be being read by another thread */
+		if (written != NULL)
+			__atomic_store_n(written, number_iter_position(iter), __ATOMIC_RELAXED);
+	}
+
+	free(batch);
+	if (!ok)
+		return FALSE;
+
+	for (i = 1; i < entries; i++)
+		index[i] += index[i - 1];
+
+	return (fseeko(out, header->index_offset, SEEK_SET) == 0) &&
+		   (fwrite(index, sizeof(uint64_t), entries, out) == entries);
+}
+
+/*
+	int open_result_store(const char * file, result_store * store)
+	maps a file written by write_result_store into memory. returns
+	FALSE if it cannot be mapped or is not a complete store.
+*/
+int open_result_store(const char *file, result_store *store)
+{
+	struct stat info;
+	store_header *header;
+	int fd;
+
+	memset(store, 0, sizeof(result_store));
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0)
+		return FALSE;
+
+	if ((fstat(fd, &info) != 0) || (info.st_size < sizeof(store_header)))
+	{
+		close(fd);
+		return FALSE;
+	}
+
+	store->size = info.st_size;
+	store->map = mmap(NULL, store->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (store->map == MAP_FAILED)
+	{
+		store->map = NULL;
+		return FALSE;
+	}
+
+	if (!valid_header(store))
+	{
+		close_result_store(store);
+		return FALSE;
+	}
+
+	header = store->map;
+	store->header = header;
+	store->index = (uint64_t *)((char *)store->map + header->index_offset);
+	store->numbers = (uint64_t *)((char *)store->map + header->numbers_offset);
+	return TRUE;
+}
+
+/*
+	int valid_header(result_store * store)
+	checks that the mapped file is a store as write_result_store writes
+	them, and all there, so that the index, numbers and piece can be
+	used without further checks. The index is read through to make sure it
+	stays within the numbers.
+*/
+int valid_header(result_store *store)
+{
+	store_header *header = store->map;
+	uint64_t *index, entries, i;
+
+	if ((memcmp(header->magic, STORE_MAGIC, sizeof(header->magic)) != 0) || (header->version != STORE_VERSION))
+		return FALSE;
+
+	if ((header->length < 1) || (header->length > PHONENO_LENGTH_MAX) || (header->prefix_digits < 1) ||
+		(header->prefix_digits > header->length) || (header->prefix_digits > STORE_PREFIX_MAX))
+		return FALSE;
+
+	/* a reader must be able to use the piece as a string */
+	if ((header->key < '0') || (header->key > '9') || (memchr(header->piece, '\0', sizeof(header->piece)) == NULL))
+		return FALSE;
+
+	/* the index and numbers must be where they are written, and aligned */
+	entries = power_of_ten(header->prefix_digits) + 1;
+
+	if ((header->index_offset != sizeof(store_header)) || (header->index_offset % sizeof(uint64_t) != 0) ||
+		(header->numbers_offset != header->index_offset + (entries * sizeof(uint64_t))) ||
+		(store->size < header->numbers_offset) ||
+		(header->count != (store->size - header->numbers_offset) / sizeof(uint64_t)) ||
+		((store->size - header->numbers_offset) % sizeof(uint64_t) != 0))
+		return FALSE;
+
+	index = (uint64_t *)((char *)store->map + header->index_offset);
+
+	if ((index[0] != 0) || (index[entries - 1] != header->count))
+		return FALSE;
+
+	for (i = 1; i < entries; i++)
+		if (index[i] < index[i - 1])
+			return FALSE;
+
+	return TRUE;
+}
+
+/*
+	void close_result_store(result_store * store)
+	unmaps the store
+*/
+void close_result_store(result_store *store)
+{
+	if (store->map != NULL)
+		munmap(store->map, store->size);
+
+	memset(store, 0, sizeof(result_store));
+	return;
+}
+
+/*
+	int store_prefix_range(result_store * store, const char * prefix, uint64_t * first, uint64_t * count)
+	sets first and count to the position and number of the numbers
+	starting with prefix, straight from the index for prefixes up to
+	prefix_digits long and by binary search within that part of the
+	store for longer ones. returns FALSE if prefix is not all digits or
+	is longer than the numbers.
+*/
+int store_prefix_range(result_store *store, const char *prefix, uint64_t *first, uint64_t *count)
+{
+	store_header *header = store->header;
+	uint64_t value = 0, scale, bucket, low, high;
+	int digits = strlen(prefix), i;
+
+	if (digits > header->length)
+		return FALSE;
+
+	for (i = 0; i < digits; i++)
+	{
+		if ((prefix[i] < '0') || (prefix[i] > '9'))
+			return FALSE;
+
+		value = (value * 10) + (prefix[i] - '0');
+	}
+
+	if (digits <= header->prefix_digits)
+	{
+		scale = power_of_ten(header->prefix_digits - digits);
+		*first = store->index[value * scale];
+		*count = store->index[(value + 1) * scale] - *first;
+		return TRUE;
+	}
+
+	/* the numbers with the prefix run from value * scale up to (value + 1) * scale */
+	scale = power_of_ten(header->length - digits);
+	bucket = value / power_of_ten(digits - header->prefix_digits);
+
+	low = lower_bound(store->numbers, store->index[bucket], store->index[bucket + 1], value * scale);
+	high = lower_bound(store->numbers, low, store->index[bucket + 1], (value + 1) * scale);
+
+	*first = low;
+	*count = high - low;
+	return TRUE;
+}
+
+/*
+	uint64_t lower_bound(uint64_t * numbers, uint64_t low, uint64_t high, uint64_t value)
+	returns the position of the first of numbers[low] to numbers[high - 1]
+	which is value or more, or high if there isn't one
+*/
+uint64_t lower_bound(uint64_t *numbers, uint64_t low, uint64_t high, uint64_t value)
+{
+	uint64_t middle;
+
+	while (low < high)
+	{
+		middle = low + ((high - low) / 2);
+
+		if (numbers[middle] < value)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+/*
+	uint64_t power_of_ten(int digits)
+	returns 10 to the power of digits
+*/
+uint64_t power_of_ten(int digits)
+{
+	uint64_t result = 1;
+
+	while (digits-- > 0)
+		result *= 10;
+
+	return result;
+}
@@ -0,0 +1,62 @@
+/*****************************************************************
+* Name:    result_store.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for result_store.c, which can be used from C
+*          or C++ without the rest of the chesspad headers
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STORE_MAGIC "CHPSTORE"
+#define STORE_VERSION 1
+#define STORE_PREFIX_MAX 4
+#define STORE_PIECE_MAX 1024
+
+/* a store file is this header, then prefix_digits worth of index,
+   then count numbers in numerical order, each packed into a uint64_t
+   as its decimal value. index[p] is the position of the first number
+   whose first prefix_digits digits are p or more, so the numbers with
+   prefix p are index[p] to index[p + 1] - 1. Everything is in the byte
+   order of the machine which wrote it. */
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t length;
+	uint32_t prefix_digits;
+	uint32_t key;
+	uint64_t count;
+	uint64_t index_offset;
+	uint64_t numbers_offset;
+	char piece[STORE_PIECE_MAX];
+} store_header;
+
+/* an open store. the pointers all point into the mapped file */
+typedef struct
+{
+	void *map;
+	uint64_t size;
+	store_header *header;
+	uint64_t *index;
+	uint64_t *numbers;
+} result_store;
+
+extern int write_result_store(const char *file, const char *piece, char start_key, int length, uint64_t *written);
+extern int open_result_store(const char *file, result_store *store);
+extern void close_result_store(result_store *store);
+extern int store_prefix_range(result_store *store, const char *prefix, uint64_t *first, uint64_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+/****************************************************************************
+* Name:    result_store_test.c
+*
+* Creator: Frank Wallis
+* Purpose: Test driver for the result store reader, run by test.sh. It
+*          opens a store written by chesspad --store, writes out what its
+*          header says, then reads one prefix per line from stdin and
+*          writes the prefix with the first position and count that
+*          store_prefix_range gives for it, eg. '55 120 37'.
+*
+* History: 18/10/2026	FW	Created.
+*****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "stdtypes.h"
+#include "chesspad.h"
+#include "result_store.h"
+
+/* prototypes */
+
+void display_usage(char *program_name);
+
+int main(int argc, char *argv[])
+{
+	char prefix[PHONENO_LENGTH_MAX + 3];
+	result_store store;
+	uint64_t first, count;
+
+	if (argc < 2)
+	{
+		display_usage(argv[0]);
+		return 1;
+	}
+
+	if (!open_result_store(argv[1], &store))
+	{
+		printf("Cannot open store %s\n", argv[1]);
+		return 1;
+	}
+
+	printf("%s %c %u %llu\n", store.header->piece, store.header->key, store.header->length,
+		   (unsigned long long)store.header->count);
+
+	while (fgets(prefix, sizeof(prefix), stdin) != NULL)
+	{
+		prefix[strcspn(prefix, "\r\n")] = '\0';
+
+		if (store_prefix_range(&store, prefix, &first, &count))
+			printf("%s %llu %llu\n", prefix, (unsigned long long)first, (unsigned long long)count);
+		else
+			printf("%s invalid\n", prefix);
+	}
+
+	close_result_store(&store);
+	return 0;
+}
+
+/*
+	void display_usage(char * program_name)
+	show accepted command line args
+*/
+void display_usage(char *program_name)
+{
+	printf("Usage %s <store_file> < <prefixes>\n", program_name);
+}
@@ -0,0 +1,168 @@
+/*****************************************************************
+* Name:    search_stats.c
+*
+* Creator: Frank Wallis
+* Purpose: Statistics for the chesspad search. The search visits one
+*          node for every path through the move graph, so rather than
+*          counting as it goes (and slowing it down) the counts are
+*          worked out from the number of paths reaching each graph
+*          node at each depth.
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "stdtypes.h"
+#include "keypad.h"
+#include "piece_defs.h"
+#include "chesspad.h"
+#include "move_graph.h"
+#include "search_stats.h"
+
+/* prototypes */
+int collect_search_stats(move_graph *graph, int root, int length, search_stats *stats);
+void write_search_stats(FILE *out, search_stats *stats);
+uint64_t clock_ns(void);
+
+int count_states(unsigned int states);
+
+/*
+	int collect_search_stats(move_graph * graph, int root, int length, search_stats * stats)
+	fills in the counts for a search of length digits from root. The
+	timings are left for the caller. returns FALSE if out of memory.
+*/
+int collect_search_stats(move_graph *graph, int root, int length, search_stats *stats)
+{
+	uint64_t *visits, *next_visits, *swap;
+	graph_node *node;
+	int depth, i, j;
+
+	memset(stats, 0, sizeof(search_stats));
+	stats->length = length;
+
+	visits = calloc(graph->node_count, sizeof(uint64_t));
+	next_visits = calloc(graph->node_count, sizeof(uint64_t));
+
+	if ((visits == NULL) || (next_visits == NULL))
+	{
+		free(visits);
+		free(next_visits);
+		return FALSE;
+	}
+
+	/* each node's moves were worked out once for every state it moves on in */
+	for (i = 0; i < graph->node_count; i++)
+		stats->lists_generated += count_states(graph->nodes[i].next_states);
+
+	visits[root] = 1;
+
+	for (depth = 1; depth <= length; depth++)
+	{
+		for (i = 0; i < graph->node_count; i++)
+		{
+			if (visits[i] == 0)
+				continue;
+
+			stats->nodes[depth] += visits[i];
+
+			/* the last digit is output rather than moved on from */
+			if (depth == length)
+				continue;
+
+			node = graph->nodes + i;
+			stats->lists_read += visits[i];
+			stats->rejected += visits[i] * node->rejected;
+
+			if (node->next_states != node->states)
+				stats->transitions += visits[i];
+
+			for (j = 0; j < node->succ_count; j++)
+				next_visits[graph->succ[node->first_succ + j]] += visits[i];
+		}
+
+		swap = visits;
+		visits = next_visits;
+		next_visits = swap;
+		memset(next_visits, 0, graph->node_count * sizeof(uint64_t));
+	}
+
+	free(visits);
+	free(next_visits);
+	return TRUE;
+}
+
+/*
+	void write_search_stats(FILE * out, search_stats * stats)
+	writes a report of the statistics
+*/
+void write_search_stats(FILE *out, search_stats *stats)
+{
+	uint64_t total = 0, parents = 0;
+	int depth;
+
+	fprintf(out, "Depth  Nodes            Branching\n");
+
+	for (depth = 1; depth <= stats->length; depth++)
+	{
+		fprintf(out, "%5d  %-15llu", depth, (unsigned long long)stats->nodes[depth]);
+
+		if (depth > 1)
+			fprintf(out, "  %.3f", (double)stats->nodes[depth] / stats->nodes[depth - 1]);
+
+		fprintf(out, "\n");
+		total += stats->nodes[depth];
+
+		if (depth < stats->length)
+			parents += stats->nodes[depth];
+	}
+
+	fprintf(out, "Nodes visited:          %llu\n", (unsigned long long)total);
+
+	if (parents > 0)
+		fprintf(out, "Average branching:      %.3f\n", (double)(total - stats->nodes[1]) / parents);
+
+	fprintf(out, "Move lists generated:   %llu (when the move graph was built)\n",
+			(unsigned long long)stats->lists_generated);
+	fprintf(out, "Move lists read:        %llu\n", (unsigned long long)stats->lists_read);
+	fprintf(out, "Moves without a digit:  %llu\n", (unsigned long long)stats->rejected);
+	fprintf(out, "Piece state changes:    %llu\n", (unsigned long long)stats->transitions);
+	fprintf(out, "Build time:             %llu ns\n", (unsigned long long)stats->build_ns);
+	fprintf(out, "Count time:             %llu ns\n", (unsigned long long)stats->count_ns);
+
+	if ((stats->search_ns > 0) || (stats->output_ns > 0))
+	{
+		fprintf(out, "Search time:            %llu ns\n", (unsigned long long)stats->search_ns);
+		fprintf(out, "Output time:            %llu ns\n", (unsigned long long)stats->output_ns);
+	}
+	return;
+}
+
+/*
+	uint64_t clock_ns(void)
+	returns a monotonic time in nanoseconds
+*/
+uint64_t clock_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/*
+	int count_states(unsigned int states)
+	returns the number of states in the set
+*/
+int count_states(unsigned int states)
+{
+	int count = 0;
+
+	for (; states != 0; states &= states - 1)
+		count++;
+
+	return count;
+}
@@ -0,0 +1,30 @@
+/*****************************************************************
+* Name:    search_stats.h
+*
+* Creator: Frank Wallis
+* Purpose: Header file for search_stats.c
+*
+* History: 18/10/2026	FW	Created.
+******************************************************************/
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+typedef struct
+{
+	int length;
+	uint64_t nodes[PHONENO_LENGTH_MAX + 1];
+	uint64_t lists_generated;
+	uint64_t lists_read;
+	uint64_t rejected;
+	uint64_t transitions;
+	uint64_t build_ns;
+	uint64_t search_ns;
+	uint64_t output_ns;
+	uint64_t count_ns;
+} search_stats;
+
+extern int collect_search_stats(move_graph *graph, int root, int length, search_stats *stats);
+extern void write_search_stats(FILE *out, search_stats *stats);
+extern uint64_t clock_ns(void);
+
+#endif
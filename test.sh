@@ -9,6 +9,12 @@
 #          All files are created in ./test directory
 # 
 # History: 08/10/2009	FW	Created.
+#          18/10/2026	FW	Added relay tests.
+#          18/10/2026	FW	Added --sorted tests.
+#          18/10/2026	FW	Added a resume test.
+#          18/10/2026	FW	Added a chesspadd test.
+#          18/10/2026	FW	Added libchesspad tests.
+#          18/10/2026	FW	Added a result store test.
 #
 if [ $# -gt 0 ] && [ $1 = 'create' ];
 then
@@ -22,12 +28,17 @@ then
 	mkdir test;
 fi
 
+# relays are named in the test files with '-' in place of '/'
+pieces="king queen bishop knight rook pawn underpawn knight/bishop bishop/knight king/knight/rook pawn/queen"
+
 # Write the testing files
-for piece in king queen bishop knight rook pawn
+for piece in $pieces
 do
+	name=`echo $piece | tr '/' '-'`;
+
 	for (( key=0; key < 10; key++ ))
 	do
-		eval filename="./test/${piece}_${key}${extension}";
+		eval filename="./test/${name}_${key}${extension}";
 		./chesspad $piece $key 5 > $filename;
 	done
 done
@@ -37,20 +48,43 @@ then
 	echo "Output master files"
 else
 	# Compare with the master files
-	for piece in king queen bishop knight rook pawn
+	for piece in $pieces
 	do
 		echo "Testing $piece's moves: ";
 		eval failed=0;
+		name=`echo $piece | tr '/' '-'`;
 		
 		for (( key = 0; key < 10; key++ ))
 		do
-			if cmp -s ./test/${piece}_${key}.test ./test/${piece}_${key}.master
+			if cmp -s ./test/${name}_${key}.test ./test/${name}_${key}.master
 			then
 				echo -n "";
 			else
 				eval failed=1;
 				echo "$key failed";
 			fi
+
+			# sorted output must be the plain output in byte order
+			if ./chesspad --sorted $piece $key 5 | cmp -s - <(LC_ALL=C sort ./test/${name}_${key}.test)
+			then
+				echo -n "";
+			else
+				eval failed=1;
+				echo "$key --sorted failed";
+			fi
+
+			# libchesspad must give the same numbers whatever the batch size
+			for batch in 1 7 65536
+			do
+				if ./number_iter_test $piece $key 5 $batch | cmp -s - ./test/${name}_${key}.test &&
+					./number_iter_test $piece $key 5 $batch sorted | cmp -s - <(./chesspad --sorted $piece $key 5)
+				then
+					echo -n "";
+				else
+					eval failed=1;
+					echo "$key libchesspad batches of $batch failed";
+				fi
+			done
 		done	
 		
 		if [ $failed = 1 ];
@@ -60,4 +94,135 @@ else
 			echo "$piece passed"
 		fi
 	done
+
+	# Stop a run part way through by limiting the size of file it may
+	# write, which kills it, then resume it from its last checkpoint and
+	# compare the result with an uninterrupted run
+	echo "Testing resume: ";
+	./chesspad knight 1 12 > ./test/resume.master;
+	rm -f ./test/resume.test ./test/resume.ckp;
+
+	{ ( ulimit -c 0; ulimit -f 2048;
+		exec ./chesspad --output=./test/resume.test --checkpoint=./test/resume.ckp \
+			--checkpoint-interval=0.001 knight 1 12 ); } 2> /dev/null
+
+	if grep -qs "^complete 0" ./test/resume.ckp &&
+		./chesspad --output=./test/resume.test --checkpoint=./test/resume.ckp --resume knight 1 12 &&
+		cmp -s ./test/resume.test ./test/resume.master
+	then
+		echo "resume passed"
+	else
+		echo "resume failed"
+	fi
+	rm -f ./test/resume.ckp;
+
+	# Look up prefixes of every length in stores, and check the ranges
+	# against the --sorted output: every prefix the numbers start with,
+	# and each of them followed by every digit, which finds some they
+	# do not
+	echo "Testing result stores: ";
+	failed=0;
+
+	for search in "knight 1 6" "queen 5 5" "pawn 0 6" "bishop 7 3" "king/knight 2 7"
+	do
+		set -- $search;
+		./chesspad --store=./test/store.chp $1 $2 $3 > /dev/null;
+
+		./chesspad --sorted $1 $2 $3 | awk -v digits=$3 -v header="$1 $2 $3" '
+			function walk(prefix, first,    digit, next_prefix, found)
+			{
+				if (length(prefix) == digits)
+					return;
+
+				for (digit = 0; digit <= 9; digit++)
+				{
+					next_prefix = prefix digit;
+					found = (next_prefix in count) ? count[next_prefix] : 0;
+					print next_prefix, first, found;
+
+					if (found > 0)
+						walk(next_prefix, first);
+					first += found;
+				}
+			}
+			{
+				for (d = 1; d <= digits; d++)
+					count[substr($0, 1, d)]++;
+			}
+			END {
+				print header, NR;
+				print "", 0, NR;
+				walk("", 0);
+			}' > ./test/store.master;
+
+		sed 1d ./test/store.master | cut -d " " -f 1 | ./result_store_test ./test/store.chp > ./test/store.test;
+
+		if ! cmp -s ./test/store.test ./test/store.master
+		then
+			failed=1;
+			echo "$search failed";
+		fi
+	done
+
+	if [ $failed = 1 ];
+	then
+		echo "result stores failed"
+	else
+		echo "result stores passed"
+	fi
+	rm -f ./test/store.chp;
+
+	# Ask chesspadd the same questions and check its answers against
+	# chesspad's output
+	echo "Testing chesspadd: ";
+	rm -f ./test/chesspadd.sock;
+	./chesspadd ./test/chesspadd.sock 2> /dev/null &
+	pid=$!;
+
+	tries=0;
+	while [ ! -S ./test/chesspadd.sock ] && [ $tries -lt 50 ]
+	do
+		sleep 0.1;
+		tries=$((tries + 1));
+	done
+
+	./chesspad queen 5 7 > ./test/chesspadd.numbers;
+	count=`wc -l < ./test/chesspadd.numbers`;
+	count=$((count));
+	member=`sed -n 778p ./test/chesspadd.numbers`;
+
+	{
+		echo "OK $count";
+		echo "OK $count";
+		cat ./test/chesspadd.numbers;
+		echo "OK 3";
+		tail -3 ./test/chesspadd.numbers;
+		echo "OK 0";
+		echo "OK 1 777";
+		echo "OK 0";
+		echo "ERR Invalid chess piece";
+		echo "ERR Phone numbers must be between 1 and 15 digits long";
+	} > ./test/chesspadd.master;
+
+	./chesspadc ./test/chesspadd.sock > ./test/chesspadd.test <<-EOF
+		COUNT 5 7 queen
+		RANGE 5 7 0 $count queen
+		RANGE 5 7 $((count - 3)) 10 queen
+		RANGE 5 7 $count 10 queen
+		MEMBER $member queen
+		MEMBER 1234567 knight
+		COUNT 5 7 dragon
+		MEMBER 12345678901234567 queen
+		QUIT
+	EOF
+
+	if cmp -s ./test/chesspadd.test ./test/chesspadd.master
+	then
+		echo "chesspadd passed"
+	else
+		echo "chesspadd failed"
+	fi
+	kill $pid;
+	wait $pid 2> /dev/null;
+	rm -f ./test/chesspadd.sock ./test/chesspadd.numbers;
 fi